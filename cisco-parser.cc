@@ -1,5 +1,8 @@
 #include "cisco-parser.h"
+#include "dscp-filter.h"
+#include "filter.h"
 #include "ns3/log.h"
+#include "traffic-class.h"
 #include <algorithm>
 #include <fstream>
 #include <sstream>
@@ -118,9 +121,7 @@ bool CiscoParser::Parse(std::string filename, uint32_t& numQueues,
       {
         uint32_t priority = it->second;
 
-        uint32_t queue =
-            (priority % (numQueues - 1)) +
-            1;
+        uint32_t queue = QueueForPriority(priority, numQueues);
 
         if (queue == i && priority < minPriority)
         {
@@ -157,6 +158,81 @@ bool CiscoParser::Parse(std::string filename, uint32_t& numQueues,
   return true;
 }
 
+void CiscoParser::GetDscpQueueMap(
+    uint32_t numQueues, std::map<uint32_t, uint32_t>& dscpToQueue) const
+{
+  NS_LOG_FUNCTION(this << numQueues);
+
+  dscpToQueue.clear();
+
+  if (!m_dscpPriorityMap.empty())
+  {
+    for (std::map<uint32_t, uint32_t>::const_iterator it =
+             m_dscpPriorityMap.begin();
+         it != m_dscpPriorityMap.end(); ++it)
+    {
+      dscpToQueue[it->first] = QueueForPriority(it->second, numQueues);
+    }
+  }
+  else
+  {
+    for (std::map<uint32_t, uint32_t>::const_iterator it = m_dscpMap.begin();
+         it != m_dscpMap.end(); ++it)
+    {
+      if (it->second < numQueues)
+      {
+        dscpToQueue[it->first] = it->second;
+      }
+    }
+  }
+}
+
+void CiscoParser::AddDscpFilters(
+    const std::vector<Ptr<TrafficClass>>& classes) const
+{
+  NS_LOG_FUNCTION(this);
+
+  uint32_t numQueues = classes.size();
+  if (numQueues == 0)
+  {
+    return;
+  }
+
+  std::map<uint32_t, uint32_t> dscpToQueue;
+  GetDscpQueueMap(numQueues, dscpToQueue);
+
+  std::vector<Ptr<DscpFilter>> dscpFilters(numQueues - 1);
+  for (uint32_t i = 0; i + 1 < numQueues; i++)
+  {
+    dscpFilters[i] = CreateObject<DscpFilter>();
+    Ptr<Filter> filter = CreateObject<Filter>();
+    filter->AddFilterElement(dscpFilters[i]);
+    classes[i]->AddFilter(filter);
+  }
+
+  for (std::map<uint32_t, uint32_t>::const_iterator it = dscpToQueue.begin();
+       it != dscpToQueue.end(); ++it)
+  {
+    uint32_t queue = it->second;
+    if (queue + 1 < numQueues)
+    {
+      dscpFilters[queue]->AddDscp(it->first);
+    }
+    NS_LOG_INFO("Classifying DSCP " << it->first << " into traffic class "
+                                    << queue);
+  }
+  NS_LOG_INFO("Unmapped DSCPs go to traffic class " << numQueues - 1);
+}
+
+uint32_t CiscoParser::QueueForPriority(uint32_t priority, uint32_t numQueues)
+{
+  if (priority == 0 || numQueues < 2)
+  {
+    return 0;
+  }
+  return ((priority - 1) % (numQueues - 1)) + 1;
+}
+
 bool CiscoParser::ParseLine(std::string line)
 {
   NS_LOG_FUNCTION(this << line);
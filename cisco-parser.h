@@ -2,6 +2,7 @@
 #define CISCO_PARSER_H
 
 #include "ns3/object.h"
+#include "ns3/ptr.h"
 #include <map>
 #include <string>
 #include <vector>
@@ -9,6 +10,8 @@
 namespace ns3
 {
 
+class TrafficClass;
+
 /**
  * \brief Parser for Cisco 3750 CLI commands for SPQ configuration
  */
@@ -29,6 +32,32 @@ public:
   bool Parse(std::string filename, uint32_t& numQueues,
              std::vector<uint32_t>& priorities);
 
+  /**
+   * \brief Get the queue each mapped DSCP codepoint is classified into
+   *
+   * Must be called after a successful Parse().  Uses the dscp-priority
+   * map when present and the dscp-queue map otherwise, with the same
+   * priority-to-queue rule Parse() uses to derive the queue priorities.
+   *
+   * \param numQueues The number of queues returned by Parse()
+   * \param dscpToQueue Output: DSCP codepoint to queue index
+   */
+  void GetDscpQueueMap(uint32_t numQueues,
+                       std::map<uint32_t, uint32_t>& dscpToQueue) const;
+
+  /**
+   * \brief Classify into the parsed queues by the trusted DSCP
+   *
+   * Every queue but the last gets a DSCP filter with the codepoints mapped
+   * to it, possibly none, so that it matches nothing else.  The last queue
+   * gets no filter: it is checked last and takes the unmapped codepoints,
+   * as well as the ones mapped to it.
+   *
+   * \param classes The traffic classes of the queues returned by Parse(),
+   *        in queue order
+   */
+  void AddDscpFilters(const std::vector<Ptr<TrafficClass>>& classes) const;
+
 protected:
   /**
    * \brief Dispose of the object
@@ -93,6 +122,14 @@ private:
    */
   std::vector<std::string> Split(std::string str, char delimiter);
 
+  /**
+   * \brief Get the queue serving a dscp-priority level
+   * \param priority The priority level
+   * \param numQueues The number of queues
+   * \return The queue index; priority 0 is the strict priority queue 0
+   */
+  static uint32_t QueueForPriority(uint32_t priority, uint32_t numQueues);
+
   bool m_qosEnabled;
   bool m_priorityQueueEnabled;
   bool m_dscpTrustEnabled;
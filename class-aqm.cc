@@ -0,0 +1,68 @@
+#include "class-aqm.h"
+#include "codel-aqm.h"
+#include "ns3/log.h"
+#include "pie-aqm.h"
+#include "red-aqm.h"
+#include <algorithm>
+#include <cctype>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ClassAqm");
+NS_OBJECT_ENSURE_REGISTERED(ClassAqm);
+
+TypeId ClassAqm::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::ClassAqm")
+                          .SetParent<Object>()
+                          .SetGroupName("Network");
+  return tid;
+}
+
+ClassAqm::ClassAqm()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+ClassAqm::~ClassAqm()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+int64_t ClassAqm::AssignStreams(int64_t stream)
+{
+  NS_LOG_FUNCTION(this << stream);
+  return 0;
+}
+
+bool ClassAqm::CreateFromName(std::string name, Ptr<ClassAqm>& aqm)
+{
+  NS_LOG_FUNCTION(name);
+
+  std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+  if (name == "red")
+  {
+    aqm = CreateObject<RedAqm>();
+  }
+  else if (name == "codel")
+  {
+    aqm = CreateObject<CodelAqm>();
+  }
+  else if (name == "pie")
+  {
+    aqm = CreateObject<PieAqm>();
+  }
+  else if (name == "none" || name == "droptail")
+  {
+    aqm = 0;
+  }
+  else
+  {
+    NS_LOG_ERROR("Unknown AQM " << name);
+    return false;
+  }
+  return true;
+}
+
+}
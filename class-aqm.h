@@ -0,0 +1,91 @@
+#ifndef CLASS_AQM_H
+#define CLASS_AQM_H
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/packet.h"
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Base class for the active queue management of a traffic class
+ *
+ * A TrafficClass consults its AQM on every arrival, before storing the
+ * packet, and on every departure, with the sojourn time measured from the
+ * timestamp taken at enqueue.  Either check may ask for the packet to be
+ * dropped; the traffic class counts the drops and reports them to the
+ * DiffServ queue.
+ */
+class ClassAqm : public Object
+{
+public:
+  /// Decision of an AQM check
+  enum Verdict
+  {
+    ACCEPT, //!< let the packet through
+    DROP,   //!< drop the packet
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Constructor
+   */
+  ClassAqm();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~ClassAqm();
+
+  /**
+   * \brief Check an arriving packet
+   * \param p The packet
+   * \param nPackets The number of packets already in the class
+   * \param nBytes The number of bytes already in the class
+   * \return The verdict
+   */
+  virtual Verdict CheckEnqueue(Ptr<const Packet> p, uint32_t nPackets,
+                               uint32_t nBytes) = 0;
+
+  /**
+   * \brief Check a departing packet
+   * \param p The packet, already removed from the class
+   * \param sojourn The time the packet spent in the class
+   * \param nPackets The number of packets left in the class
+   * \param nBytes The number of bytes left in the class
+   * \return The verdict
+   */
+  virtual Verdict CheckDequeue(Ptr<const Packet> p, Time sojourn,
+                               uint32_t nPackets, uint32_t nBytes) = 0;
+
+  /**
+   * \brief Assign a fixed random variable stream number
+   * \param stream First stream index to use
+   * \return The number of stream indices assigned
+   */
+  virtual int64_t AssignStreams(int64_t stream);
+
+  /**
+   * \brief Create an AQM from its configuration file name
+   *
+   * Recognized names are "red", "codel" and "pie" (case-insensitive);
+   * "none" or "droptail" select plain tail drop.
+   *
+   * \param name The name
+   * \param aqm Output: the new AQM, or 0 for tail drop
+   * \return False if the name is not recognized
+   */
+  static bool CreateFromName(std::string name, Ptr<ClassAqm>& aqm);
+};
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#include "codel-aqm.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CodelAqm");
+NS_OBJECT_ENSURE_REGISTERED(CodelAqm);
+
+TypeId CodelAqm::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::CodelAqm")
+          .SetParent<ClassAqm>()
+          .SetGroupName("Network")
+          .AddConstructor<CodelAqm>()
+          .AddAttribute("Target", "The acceptable standing sojourn time",
+                        TimeValue(MilliSeconds(5)),
+                        MakeTimeAccessor(&CodelAqm::m_target),
+                        MakeTimeChecker())
+          .AddAttribute("Interval",
+                        "The window over which the sojourn time must stay "
+                        "above Target before dropping",
+                        TimeValue(MilliSeconds(100)),
+                        MakeTimeAccessor(&CodelAqm::m_interval),
+                        MakeTimeChecker())
+          .AddAttribute("MinBytes",
+                        "Never drop while at most this many bytes are left "
+                        "in the class (one MTU)",
+                        UintegerValue(1500),
+                        MakeUintegerAccessor(&CodelAqm::m_minBytes),
+                        MakeUintegerChecker<uint32_t>());
+  return tid;
+}
+
+CodelAqm::CodelAqm()
+    : ClassAqm(), m_target(MilliSeconds(5)), m_interval(MilliSeconds(100)),
+      m_minBytes(1500), m_firstAboveTime(Time(0)), m_dropNext(Time(0)),
+      m_count(0), m_lastCount(0), m_dropping(false)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+CodelAqm::~CodelAqm()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+ClassAqm::Verdict CodelAqm::CheckEnqueue(Ptr<const Packet> p,
+                                         uint32_t nPackets, uint32_t nBytes)
+{
+  return ACCEPT;
+}
+
+Time CodelAqm::ControlLaw(Time t) const
+{
+  return t + Seconds(m_interval.GetSeconds() / std::sqrt(m_count));
+}
+
+bool CodelAqm::IsAboveTarget(Time sojourn, uint32_t nBytes, Time now)
+{
+  if (sojourn < m_target || nBytes <= m_minBytes)
+  {
+    m_firstAboveTime = Time(0);
+    return false;
+  }
+  if (m_firstAboveTime.IsZero())
+  {
+    m_firstAboveTime = now + m_interval;
+    return false;
+  }
+  return now >= m_firstAboveTime;
+}
+
+ClassAqm::Verdict CodelAqm::CheckDequeue(Ptr<const Packet> p, Time sojourn,
+                                         uint32_t nPackets, uint32_t nBytes)
+{
+  NS_LOG_FUNCTION(this << p << sojourn << nPackets << nBytes);
+
+  Time now = Simulator::Now();
+  bool aboveTarget = IsAboveTarget(sojourn, nBytes, now);
+
+  if (m_dropping)
+  {
+    if (!aboveTarget)
+    {
+      NS_LOG_LOGIC("Sojourn time below target, leaving dropping state");
+      m_dropping = false;
+      return ACCEPT;
+    }
+    if (now >= m_dropNext)
+    {
+      m_count++;
+      m_dropNext = ControlLaw(m_dropNext);
+      NS_LOG_LOGIC("Drop " << m_count << " in dropping state");
+      return DROP;
+    }
+    return ACCEPT;
+  }
+
+  if (aboveTarget)
+  {
+    // Resume close to the previous drop rate if the last episode was recent
+    uint32_t delta = m_count - m_lastCount;
+    m_count = (delta > 1 && now - m_dropNext < m_interval * int64_t(16))
+                  ? delta
+                  : 1;
+    m_dropping = true;
+    m_dropNext = ControlLaw(now);
+    m_lastCount = m_count;
+    NS_LOG_LOGIC("Entering dropping state, count " << m_count);
+    return DROP;
+  }
+  return ACCEPT;
+}
+
+}
@@ -0,0 +1,70 @@
+#ifndef CODEL_AQM_H
+#define CODEL_AQM_H
+
+#include "class-aqm.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Controlled Delay (RFC 8289) for a traffic class
+ *
+ * Drops at dequeue once the sojourn time has stayed above Target for a
+ * whole Interval, then spaces further drops by Interval / sqrt(count)
+ * until the sojourn time falls back below Target.
+ */
+class CodelAqm : public ClassAqm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Constructor
+   */
+  CodelAqm();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~CodelAqm();
+
+  virtual Verdict CheckEnqueue(Ptr<const Packet> p, uint32_t nPackets,
+                               uint32_t nBytes) override;
+  virtual Verdict CheckDequeue(Ptr<const Packet> p, Time sojourn,
+                               uint32_t nPackets, uint32_t nBytes) override;
+
+private:
+  /**
+   * \brief Check if the sojourn time has been above target for an interval
+   * \param sojourn The sojourn time of the departing packet
+   * \param nBytes The number of bytes left in the class
+   * \param now The current time
+   * \return True if dropping is allowed
+   */
+  bool IsAboveTarget(Time sojourn, uint32_t nBytes, Time now);
+
+  /**
+   * \brief Compute the time of the next drop
+   * \param t The time of the current drop
+   * \return The time of the next drop
+   */
+  Time ControlLaw(Time t) const;
+
+  Time m_target;         //!< acceptable standing sojourn time
+  Time m_interval;       //!< sliding window to detect a standing queue
+  uint32_t m_minBytes;   //!< never drop with this little backlog
+  Time m_firstAboveTime; //!< when the sojourn time may be declared standing
+  Time m_dropNext;       //!< time of the next drop in the dropping state
+  uint32_t m_count;      //!< drops since entering the dropping state
+  uint32_t m_lastCount;  //!< count when the dropping state was last left
+  bool m_dropping;       //!< in the dropping state
+};
+
+}
+
+#endif
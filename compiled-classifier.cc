@@ -0,0 +1,199 @@
+#include "compiled-classifier.h"
+#include "ns3/log.h"
+#include "traffic-class.h"
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("CompiledClassifier");
+
+uint64_t CompiledClassifier::s_generation = 0;
+
+CompiledClassifier::CompiledClassifier()
+    : m_tuples(), m_nRules(0), m_sourceIndex(), m_destinationIndex(),
+      m_pruneSource(false), m_pruneDestination(false), m_dscpOnly(false)
+{
+  for (uint32_t i = 0; i < 64; i++)
+  {
+    m_dscpTable[i] = NO_MATCH;
+  }
+}
+
+uint64_t CompiledClassifier::GetLengthBit(uint32_t mask)
+{
+  // A zero mask matches every address, so there is nothing to prune
+  uint8_t length;
+  if (mask == 0 || !Ipv4PrefixIndex::GetPrefixLength(mask, length))
+  {
+    return 0;
+  }
+  return static_cast<uint64_t>(1) << length;
+}
+
+Ptr<CompiledClassifier>
+CompiledClassifier::Compile(const std::vector<Ptr<TrafficClass>>& classes)
+{
+  NS_LOG_FUNCTION(classes.size());
+
+  Ptr<CompiledClassifier> compiled = Create<CompiledClassifier>();
+
+  std::unordered_map<FlowKey, uint32_t, FlowKeyHash> tupleIndex;
+
+  for (uint32_t i = 0; i < classes.size(); i++)
+  {
+    std::vector<FlowPattern> patterns;
+    if (!classes[i]->GetPatterns(patterns))
+    {
+      NS_LOG_LOGIC("Traffic class " << i << " cannot be compiled");
+      return 0;
+    }
+
+    for (uint32_t j = 0; j < patterns.size(); j++)
+    {
+      const FlowPattern& pattern = patterns[j];
+
+      std::unordered_map<FlowKey, uint32_t, FlowKeyHash>::iterator it =
+          tupleIndex.find(pattern.mask);
+      if (it == tupleIndex.end())
+      {
+        Tuple tuple;
+        tuple.mask = pattern.mask;
+        tuple.firstClass = i;
+        tuple.sourceLength = GetLengthBit(pattern.mask.source);
+        tuple.destinationLength = GetLengthBit(pattern.mask.destination);
+        compiled->m_tuples.push_back(tuple);
+        it = tupleIndex.insert(std::make_pair(pattern.mask,
+                                              compiled->m_tuples.size() - 1))
+                 .first;
+      }
+
+      // Classes are visited in order, so the first insertion of a masked
+      // key is the one with the lowest class index
+      Tuple& tuple = compiled->m_tuples[it->second];
+      if (!tuple.classes.insert(std::make_pair(pattern.value, i)).second)
+      {
+        continue;
+      }
+      compiled->m_nRules++;
+
+      if (tuple.sourceLength)
+      {
+        compiled->m_sourceIndex.Insert(pattern.value.source,
+                                       __builtin_ctzll(tuple.sourceLength));
+        compiled->m_pruneSource = true;
+      }
+      if (tuple.destinationLength)
+      {
+        compiled->m_destinationIndex.Insert(
+            pattern.value.destination,
+            __builtin_ctzll(tuple.destinationLength));
+        compiled->m_pruneDestination = true;
+      }
+    }
+  }
+
+  std::stable_sort(compiled->m_tuples.begin(), compiled->m_tuples.end(),
+                   [](const Tuple& a, const Tuple& b) {
+                     return a.firstClass < b.firstClass;
+                   });
+  compiled->BuildDscpTable();
+
+  NS_LOG_INFO("Compiled " << classes.size() << " traffic classes into "
+                          << compiled->m_nRules << " patterns in "
+                          << compiled->m_tuples.size() << " tuples");
+  return compiled;
+}
+
+void CompiledClassifier::BuildDscpTable(void)
+{
+  for (uint32_t i = 0; i < m_tuples.size(); i++)
+  {
+    FlowKey dscpOnly = {};
+    dscpOnly.dscp = m_tuples[i].mask.dscp;
+    dscpOnly.flags = m_tuples[i].mask.flags & FlowKey::IPV4;
+    if (!(m_tuples[i].mask == dscpOnly))
+    {
+      return;
+    }
+  }
+
+  for (uint8_t dscp = 0; dscp < 64; dscp++)
+  {
+    FlowKey key = {};
+    key.dscp = dscp;
+    key.flags = FlowKey::IPV4;
+    m_dscpTable[dscp] = SearchTuples(key);
+  }
+  m_dscpOnly = true;
+  NS_LOG_INFO("Rule set only depends on the DSCP, using table lookup");
+}
+
+uint32_t CompiledClassifier::Classify(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (m_dscpOnly && (key.flags & FlowKey::IPV4))
+  {
+    return m_dscpTable[key.dscp];
+  }
+  return SearchTuples(key);
+}
+
+uint32_t CompiledClassifier::SearchTuples(const FlowKey& key) const
+{
+  // Prefix lengths of the configured prefixes covering the addresses; a
+  // tuple whose length is not among them cannot match
+  uint64_t sourceLengths =
+      m_pruneSource ? m_sourceIndex.Lookup(key.source) : ~0ULL;
+  uint64_t destinationLengths =
+      m_pruneDestination ? m_destinationIndex.Lookup(key.destination) : ~0ULL;
+
+  uint32_t best = NO_MATCH;
+  for (std::vector<Tuple>::const_iterator t = m_tuples.begin();
+       t != m_tuples.end() && t->firstClass < best; ++t)
+  {
+    if ((t->sourceLength & ~sourceLengths) ||
+        (t->destinationLength & ~destinationLengths))
+    {
+      continue;
+    }
+
+    std::unordered_map<FlowKey, uint32_t, FlowKeyHash>::const_iterator it =
+        t->classes.find(key.Mask(t->mask));
+    if (it != t->classes.end() && it->second < best)
+    {
+      best = it->second;
+    }
+  }
+
+  NS_LOG_LOGIC("Compiled lookup result " << best);
+  return best;
+}
+
+uint32_t CompiledClassifier::GetNRules(void) const
+{
+  return m_nRules;
+}
+
+uint32_t CompiledClassifier::GetNTuples(void) const
+{
+  return m_tuples.size();
+}
+
+bool CompiledClassifier::IsDscpOnly(void) const
+{
+  return m_dscpOnly;
+}
+
+void CompiledClassifier::NotifyRulesChanged(void)
+{
+  s_generation++;
+}
+
+uint64_t CompiledClassifier::GetRulesGeneration(void)
+{
+  return s_generation;
+}
+
+}
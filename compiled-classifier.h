@@ -0,0 +1,144 @@
+#ifndef COMPILED_CLASSIFIER_H
+#define COMPILED_CLASSIFIER_H
+
+#include "flow-key.h"
+#include "ipv4-prefix-index.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class TrafficClass;
+
+/**
+ * \ingroup diffserv
+ * \brief Immutable lookup structure compiled from a set of traffic classes
+ *
+ * The TrafficClass/Filter/FilterElement tree is flattened into masked key
+ * patterns, which are grouped by mask into tuples (tuple space search).
+ * Each tuple is a hash table from masked key to the lowest class index
+ * owning that pattern, and tuples are ordered by the lowest class index
+ * they contain, so a lookup stops as soon as no remaining tuple can beat
+ * the best match found so far.  Classification cost therefore depends on
+ * the number of distinct masks in the configuration rather than on the
+ * number of rules, and the first-match semantics of the linear scan over
+ * the classes is preserved.
+ *
+ * Tuples whose source or destination mask is a prefix mask are further
+ * pruned with one Ipv4PrefixIndex per address: a lookup yields the set
+ * of configured prefix lengths covering the packet's address, and tuples
+ * with any other length are skipped without hashing.
+ *
+ * When every pattern constrains nothing but the DSCP (the usual core
+ * router configuration), the result for IPv4 packets is precomputed into
+ * a 64-entry table and a lookup is a single array index.
+ */
+class CompiledClassifier : public SimpleRefCount<CompiledClassifier>
+{
+public:
+  /// Returned by Classify() when no class matches
+  static const uint32_t NO_MATCH = 0xffffffff;
+
+  /**
+   * \brief Constructor for an empty classifier; use Compile() instead
+   */
+  CompiledClassifier();
+
+  /**
+   * \brief Compile a set of traffic classes
+   * \param classes The traffic classes, in first-match order
+   * \return The classifier, or 0 if a filter element cannot be compiled
+   */
+  static Ptr<CompiledClassifier>
+  Compile(const std::vector<Ptr<TrafficClass>>& classes);
+
+  /**
+   * \brief Find the first traffic class matching a key
+   * \param key The classification key parsed from the packet
+   * \return The class index, or NO_MATCH
+   */
+  uint32_t Classify(const FlowKey& key) const;
+
+  /**
+   * \brief Get the number of distinct patterns in the classifier
+   * \return The number of patterns
+   */
+  uint32_t GetNRules(void) const;
+
+  /**
+   * \brief Get the number of distinct masks in the classifier
+   * \return The number of tuples searched in the worst case
+   */
+  uint32_t GetNTuples(void) const;
+
+  /**
+   * \brief Check if IPv4 packets are classified by DSCP table lookup
+   * \return True if the rule set only looks at the DSCP
+   */
+  bool IsDscpOnly(void) const;
+
+  /**
+   * \brief Record that a traffic class, filter or filter element changed
+   *
+   * Owners of a compiled classifier compare GetRulesGeneration() with the
+   * generation they last checked.  When it has moved, they compare the
+   * rule versions of their own traffic classes (see
+   * TrafficClass::GetRulesVersion) with the ones they compiled and
+   * recompile only if those moved.
+   */
+  static void NotifyRulesChanged(void);
+
+  /**
+   * \brief Get the current rule set generation
+   * \return The generation counter
+   */
+  static uint64_t GetRulesGeneration(void);
+
+private:
+  /// Patterns sharing one mask
+  struct Tuple
+  {
+    FlowKey mask;        //!< mask shared by all patterns of the tuple
+    uint32_t firstClass; //!< lowest class index stored in the tuple
+    uint64_t sourceLength;      //!< bit of the source prefix length, or 0
+    uint64_t destinationLength; //!< bit of the destination prefix length, or 0
+    std::unordered_map<FlowKey, uint32_t, FlowKeyHash> classes; //!< masked key to class index
+  };
+
+  /**
+   * \brief Get the prefix length bit used to prune on an address mask
+   * \param mask The address mask of a tuple
+   * \return The bit of the prefix length, or 0 if the tuple can't be pruned
+   */
+  static uint64_t GetLengthBit(uint32_t mask);
+
+  /**
+   * \brief Search the tuples for the first class matching a key
+   * \param key The classification key
+   * \return The class index, or NO_MATCH
+   */
+  uint32_t SearchTuples(const FlowKey& key) const;
+
+  /**
+   * \brief Fill m_dscpTable if the rule set only looks at the DSCP
+   */
+  void BuildDscpTable(void);
+
+  std::vector<Tuple> m_tuples; //!< tuples sorted by firstClass
+  uint32_t m_nRules;           //!< number of stored patterns
+  Ipv4PrefixIndex m_sourceIndex;      //!< source prefixes of pruned tuples
+  Ipv4PrefixIndex m_destinationIndex; //!< destination prefixes of pruned tuples
+  bool m_pruneSource;      //!< some tuple has a source prefix length bit
+  bool m_pruneDestination; //!< some tuple has a destination prefix length bit
+  bool m_dscpOnly;          //!< m_dscpTable is valid for IPv4 packets
+  uint32_t m_dscpTable[64]; //!< class index per DSCP codepoint
+
+  static uint64_t s_generation; //!< rule set generation counter
+};
+
+}
+
+#endif
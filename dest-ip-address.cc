@@ -1,5 +1,4 @@
 #include "dest-ip-address.h"
-#include "ns3/ipv4-header.h"
 #include "ns3/log.h"
 
 namespace ns3
@@ -38,18 +37,15 @@ void DestIpAddress::DoDispose(void)
   FilterElement::DoDispose();
 }
 
-bool DestIpAddress::Match(Ptr<Packet> p)
+bool DestIpAddress::Match(const FlowKey& key) const
 {
-  NS_LOG_FUNCTION(this << p);
+  NS_LOG_FUNCTION(this << key);
 
-  Ptr<Packet> copy = p->Copy();
-
-  Ipv4Header ipv4Header;
-  if (copy->PeekHeader(ipv4Header))
+  if (key.flags & FlowKey::IPV4)
   {
-    bool match = (ipv4Header.GetDestination() == m_address);
+    bool match = (key.destination == m_address.Get());
     NS_LOG_LOGIC("Destination IP address "
-                 << ipv4Header.GetDestination() << " "
+                 << Ipv4Address(key.destination) << " "
                  << (match ? "matches" : "doesn't match") << " filter "
                  << m_address);
     return match;
@@ -59,10 +55,24 @@ bool DestIpAddress::Match(Ptr<Packet> p)
   return false;
 }
 
+bool DestIpAddress::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  FlowPattern pattern = FlowPattern::Any();
+  pattern.value.destination = m_address.Get();
+  pattern.mask.destination = 0xffffffff;
+  pattern.value.flags = FlowKey::IPV4;
+  pattern.mask.flags = FlowKey::IPV4;
+  patterns.push_back(pattern);
+  return true;
+}
+
 void DestIpAddress::SetAddress(Ipv4Address addr)
 {
   NS_LOG_FUNCTION(this << addr);
   m_address = addr;
+  NotifyRulesChanged();
 }
 
 Ipv4Address DestIpAddress::GetAddress(void) const
@@ -0,0 +1,99 @@
+#include "dest-ip-mask.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DestIpMask");
+NS_OBJECT_ENSURE_REGISTERED(DestIpMask);
+
+TypeId DestIpMask::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::DestIpMask")
+                          .SetParent<FilterElement>()
+                          .SetGroupName("Network")
+                          .AddConstructor<DestIpMask>();
+  return tid;
+}
+
+DestIpMask::DestIpMask()
+    : m_address(Ipv4Address::GetAny()), m_mask(Ipv4Mask::GetZero())
+{
+  NS_LOG_FUNCTION(this);
+}
+
+DestIpMask::DestIpMask(Ipv4Address addr, Ipv4Mask mask)
+    : m_address(addr), m_mask(mask)
+{
+  NS_LOG_FUNCTION(this << addr << mask);
+}
+
+DestIpMask::~DestIpMask()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void DestIpMask::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  FilterElement::DoDispose();
+}
+
+bool DestIpMask::Match(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (key.flags & FlowKey::IPV4)
+  {
+    bool match = ((key.destination ^ m_address.Get()) & m_mask.Get()) == 0;
+    NS_LOG_LOGIC("Destination IP address "
+                 << Ipv4Address(key.destination) << " "
+                 << (match ? "matches" : "doesn't match") << " prefix "
+                 << m_address << "/" << m_mask.GetPrefixLength());
+    return match;
+  }
+
+  NS_LOG_LOGIC("Packet doesn't have an IPv4 header");
+  return false;
+}
+
+bool DestIpMask::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  FlowPattern pattern = FlowPattern::Any();
+  pattern.value.destination = m_address.Get() & m_mask.Get();
+  pattern.mask.destination = m_mask.Get();
+  pattern.value.flags = FlowKey::IPV4;
+  pattern.mask.flags = FlowKey::IPV4;
+  patterns.push_back(pattern);
+  return true;
+}
+
+void DestIpMask::SetAddress(Ipv4Address addr)
+{
+  NS_LOG_FUNCTION(this << addr);
+  m_address = addr;
+  NotifyRulesChanged();
+}
+
+Ipv4Address DestIpMask::GetAddress(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_address;
+}
+
+void DestIpMask::SetMask(Ipv4Mask mask)
+{
+  NS_LOG_FUNCTION(this << mask);
+  m_mask = mask;
+  NotifyRulesChanged();
+}
+
+Ipv4Mask DestIpMask::GetMask(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_mask;
+}
+
+}
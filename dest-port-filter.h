@@ -2,8 +2,6 @@
 #define DEST_PORT_FILTER_H
 
 #include "filter-element.h"
-#include "ns3/ipv4-header.h"
-#include "ns3/tcp-header.h"
 
 namespace ns3
 {
@@ -25,16 +23,24 @@ public:
   {
   }
 
-  bool Match(Ptr<Packet> p) override
+  bool Match(const FlowKey& key) const override
   {
-    Ptr<Packet> c = p->Copy();
-    Ipv4Header ip;
-    if (!c->RemoveHeader(ip) || ip.GetProtocol() != 6)
+    if (!(key.flags & FlowKey::PORTS) || key.protocol != 6)
       return false;
-    TcpHeader tcp;
-    if (!c->PeekHeader(tcp))
-      return false;
-    return tcp.GetDestinationPort() == m_port;
+    return key.destinationPort == m_port;
+  }
+
+  bool GetPatterns(std::vector<FlowPattern>& patterns) const override
+  {
+    FlowPattern pattern = FlowPattern::Any();
+    pattern.value.protocol = 6;
+    pattern.mask.protocol = 0xff;
+    pattern.value.destinationPort = m_port;
+    pattern.mask.destinationPort = 0xffff;
+    pattern.value.flags = FlowKey::PORTS;
+    pattern.mask.flags = FlowKey::PORTS;
+    patterns.push_back(pattern);
+    return true;
   }
 
 private:
@@ -0,0 +1,92 @@
+#include "dest-port-range.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DestPortRange");
+NS_OBJECT_ENSURE_REGISTERED(DestPortRange);
+
+TypeId DestPortRange::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::DestPortRange")
+                          .SetParent<FilterElement>()
+                          .SetGroupName("Network")
+                          .AddConstructor<DestPortRange>();
+  return tid;
+}
+
+DestPortRange::DestPortRange() : m_ports()
+{
+  NS_LOG_FUNCTION(this);
+  m_ports.AddRange(0, 65535);
+}
+
+DestPortRange::DestPortRange(uint16_t first, uint16_t last) : m_ports()
+{
+  NS_LOG_FUNCTION(this << first << last);
+  m_ports.AddRange(first, last);
+}
+
+DestPortRange::~DestPortRange()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void DestPortRange::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  FilterElement::DoDispose();
+}
+
+bool DestPortRange::Match(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (!(key.flags & FlowKey::PORTS))
+  {
+    NS_LOG_LOGIC("Packet doesn't have TCP or UDP ports");
+    return false;
+  }
+
+  bool match = m_ports.Contains(key.destinationPort);
+  NS_LOG_LOGIC("Destination port " << key.destinationPort << " "
+                              << (match ? "matches" : "doesn't match"));
+  return match;
+}
+
+bool DestPortRange::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  std::vector<uint16_t> values;
+  std::vector<uint16_t> masks;
+  m_ports.GetBlocks(values, masks);
+
+  for (uint32_t i = 0; i < values.size(); i++)
+  {
+    FlowPattern pattern = FlowPattern::Any();
+    pattern.value.destinationPort = values[i];
+    pattern.mask.destinationPort = masks[i];
+    pattern.value.flags = FlowKey::PORTS;
+    pattern.mask.flags = FlowKey::PORTS;
+    patterns.push_back(pattern);
+  }
+  return true;
+}
+
+void DestPortRange::AddRange(uint16_t first, uint16_t last)
+{
+  NS_LOG_FUNCTION(this << first << last);
+  m_ports.AddRange(first, last);
+  NotifyRulesChanged();
+}
+
+void DestPortRange::ClearRanges(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_ports.Clear();
+  NotifyRulesChanged();
+}
+
+}
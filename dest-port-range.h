@@ -0,0 +1,77 @@
+#ifndef DEST_PORT_RANGE_H
+#define DEST_PORT_RANGE_H
+
+#include "filter-element.h"
+#include "port-bitmap.h"
+
+namespace ns3
+{
+
+/**
+ * \brief Filter element for ranges of TCP or UDP destination ports
+ */
+class DestPortRange : public FilterElement
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Default constructor, matches every destination port
+   */
+  DestPortRange();
+
+  /**
+   * \brief Constructor with a single range
+   * \param first The first destination port of the range
+   * \param last The last destination port of the range
+   */
+  DestPortRange(uint16_t first, uint16_t last);
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~DestPortRange();
+
+  /**
+   * \brief Check if a packet matches this filter element
+   * \param key The classification key parsed from the packet
+   * \return True if the packet is TCP or UDP and its destination port is in
+   *         one of the ranges
+   */
+  virtual bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe the ranges as aligned blocks of destination ports
+   * \param patterns Output: the patterns
+   * \return Always true
+   */
+  virtual bool GetPatterns(std::vector<FlowPattern>& patterns) const;
+
+  /**
+   * \brief Add a range of destination ports to match
+   * \param first The first port of the range
+   * \param last The last port of the range
+   */
+  void AddRange(uint16_t first, uint16_t last);
+
+  /**
+   * \brief Remove all ranges; the element then matches no packet
+   */
+  void ClearRanges(void);
+
+private:
+  PortBitmap m_ports; //!< The destination ports to match
+
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose(void);
+};
+
+}
+
+#endif
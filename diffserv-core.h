@@ -0,0 +1,255 @@
+#ifndef DIFFSERV_CORE_H
+#define DIFFSERV_CORE_H
+
+#include "flow-key.h"
+#include "ns3/assert.h"
+#include "ring-buffer.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Classification, buffering and scheduling of DiffServ classes,
+ *        specialized at compile time
+ *
+ * The dynamic DiffServ queue reaches its classifier, scheduler and filter
+ * elements through virtual calls and stores packets in TrafficClass
+ * objects.  This core takes them as template parameters instead, so that
+ * the whole per-packet path can be inlined, and keeps its per-class FIFOs
+ * in ring buffers of plain handles.  It holds no ns-3 objects itself: the
+ * queue that owns it stores the packets and passes handles to them (see
+ * StaticDiffServ).
+ *
+ * The policies are duck-typed (see diffserv-policies.h):
+ * - Classifier: uint32_t Classify(const FlowKey&) const
+ * - Scheduler: SetNClasses(n), NotifyBacklogged(c), uint32_t Select(queues)
+ *   and NotifyServed(c, size, empty); Select must return the same class
+ *   when called again before anything is served or enqueued
+ * - BufferPolicy: bool Admit(classPackets, classBytes, size) const
+ *
+ * The scheduling decision is cached until the next Push or Pop, so that
+ * peeking and dequeuing agree and cost one selection.
+ *
+ * \tparam Classifier The classifier policy
+ * \tparam Scheduler The scheduler policy
+ * \tparam BufferPolicy The admission policy of the classes
+ * \tparam Handle The type standing for a stored packet
+ */
+template <typename Classifier, typename Scheduler, typename BufferPolicy,
+          typename Handle>
+class DiffServCore
+{
+public:
+  /// A stored packet
+  struct Entry
+  {
+    Handle handle; //!< packet handle given by the owner
+    uint32_t size; //!< packet size in bytes
+  };
+
+  /// Per-class FIFOs, as seen by the scheduler
+  typedef std::vector<RingBuffer<Entry>> Queues;
+
+  DiffServCore() : m_queues(), m_bytes(), m_nPackets(0), m_selected(0),
+                   m_selectionValid(false)
+  {
+  }
+
+  /**
+   * \brief Set the number of classes; the core must be empty
+   * \param nClasses The number of classes
+   * \param reserve The number of packets preallocated per class
+   */
+  void SetNClasses(uint32_t nClasses, uint32_t reserve)
+  {
+    NS_ASSERT(m_nPackets == 0);
+    m_queues.assign(nClasses, RingBuffer<Entry>());
+    for (uint32_t i = 0; i < nClasses; i++)
+    {
+      m_queues[i].Reserve(reserve);
+    }
+    m_bytes.assign(nClasses, 0);
+    m_scheduler.SetNClasses(nClasses);
+    m_selectionValid = false;
+  }
+
+  /**
+   * \return The number of classes
+   */
+  uint32_t GetNClasses(void) const
+  {
+    return m_queues.size();
+  }
+
+  /**
+   * \return The classifier, to install rules
+   */
+  Classifier& GetClassifier(void)
+  {
+    return m_classifier;
+  }
+
+  /**
+   * \return The scheduler, to set priorities or quanta
+   */
+  Scheduler& GetScheduler(void)
+  {
+    return m_scheduler;
+  }
+
+  /**
+   * \return The buffer policy, to set limits
+   */
+  BufferPolicy& GetBufferPolicy(void)
+  {
+    return m_buffer;
+  }
+
+  /**
+   * \return The buffer policy
+   */
+  const BufferPolicy& GetBufferPolicy(void) const
+  {
+    return m_buffer;
+  }
+
+  /**
+   * \brief Classify a parsed packet
+   * \param key The classification key
+   * \return The class; 0 if the classifier names no existing class
+   */
+  uint32_t Classify(const FlowKey& key) const
+  {
+    uint32_t classIndex = m_classifier.Classify(key);
+    return (classIndex < m_queues.size()) ? classIndex : 0;
+  }
+
+  /**
+   * \brief Check an arrival against the buffer policy
+   * \param classIndex The class of the packet
+   * \param size The packet size
+   * \return True if the class admits the packet
+   */
+  bool Admit(uint32_t classIndex, uint32_t size) const
+  {
+    return m_buffer.Admit(m_queues[classIndex].GetSize(), m_bytes[classIndex],
+                          size);
+  }
+
+  /**
+   * \brief Store an admitted packet
+   * \param classIndex The class of the packet
+   * \param handle The packet handle
+   * \param size The packet size
+   */
+  void Push(uint32_t classIndex, const Handle& handle, uint32_t size)
+  {
+    Entry entry = {handle, size};
+    bool wasEmpty = m_queues[classIndex].IsEmpty();
+    m_queues[classIndex].Push(entry);
+    m_bytes[classIndex] += size;
+    m_nPackets++;
+    if (wasEmpty)
+    {
+      m_scheduler.NotifyBacklogged(classIndex);
+    }
+    m_selectionValid = false;
+  }
+
+  /**
+   * \brief Get the class the scheduler serves next
+   * \return The class, or GetNClasses() if the core is empty
+   */
+  uint32_t Select(void)
+  {
+    if (!m_selectionValid)
+    {
+      m_selected = (m_nPackets == 0) ? m_queues.size()
+                                     : m_scheduler.Select(m_queues);
+      m_selectionValid = true;
+    }
+    return m_selected;
+  }
+
+  /**
+   * \brief Get the packet the scheduler serves next
+   * \param handle Receives the handle of the packet
+   * \return False if the core is empty
+   */
+  bool Peek(Handle& handle)
+  {
+    uint32_t classIndex = Select();
+    if (classIndex >= m_queues.size())
+    {
+      return false;
+    }
+    handle = m_queues[classIndex].Front().handle;
+    return true;
+  }
+
+  /**
+   * \brief Remove the packet the scheduler serves next
+   * \param handle Receives the handle of the packet
+   * \return False if the core is empty
+   */
+  bool Pop(Handle& handle)
+  {
+    uint32_t classIndex = Select();
+    if (classIndex >= m_queues.size())
+    {
+      return false;
+    }
+    Entry entry = m_queues[classIndex].Pop();
+    m_bytes[classIndex] -= entry.size;
+    m_nPackets--;
+    m_scheduler.NotifyServed(classIndex, entry.size,
+                             m_queues[classIndex].IsEmpty());
+    m_selectionValid = false;
+    handle = entry.handle;
+    return true;
+  }
+
+  /**
+   * \brief Drop every stored handle
+   */
+  void Clear(void)
+  {
+    m_nPackets = 0;
+    SetNClasses(0, 0);
+  }
+
+  /**
+   * \param classIndex The class
+   * \return The number of packets stored in the class
+   */
+  uint32_t GetNPackets(uint32_t classIndex) const
+  {
+    return m_queues[classIndex].GetSize();
+  }
+
+  /**
+   * \param classIndex The class
+   * \return The number of bytes stored in the class
+   */
+  uint32_t GetNBytes(uint32_t classIndex) const
+  {
+    return m_bytes[classIndex];
+  }
+
+private:
+  Classifier m_classifier;       //!< classifier policy
+  Scheduler m_scheduler;         //!< scheduler policy
+  BufferPolicy m_buffer;         //!< admission policy
+  Queues m_queues;               //!< per-class FIFOs
+  std::vector<uint32_t> m_bytes; //!< stored bytes per class
+  uint32_t m_nPackets;           //!< stored packets in all classes
+  uint32_t m_selected;           //!< cached scheduling decision
+  bool m_selectionValid;         //!< m_selected is up to date
+};
+
+}
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef DIFFSERV_POLICIES_H
+#define DIFFSERV_POLICIES_H
+
+#include "flow-key.h"
+#include "ns3/assert.h"
+#include <algorithm>
+#include <deque>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Classifier policy mapping destination ports to classes
+ *
+ * Meant for the few port rules of a validation scenario: the rules are a
+ * sorted array searched by bisection.  Packets without ports, or with an
+ * unmapped port, go to class 0.
+ */
+class DestPortClassifier
+{
+public:
+  /**
+   * \brief Map a destination port (TCP or UDP) to a class
+   * \param port The port
+   * \param classIndex The class
+   */
+  void Add(uint16_t port, uint32_t classIndex)
+  {
+    Rule rule(port, classIndex);
+    std::vector<Rule>::iterator it =
+        std::lower_bound(m_rules.begin(), m_rules.end(), rule);
+    if (it != m_rules.end() && it->first == port)
+    {
+      it->second = classIndex;
+      return;
+    }
+    m_rules.insert(it, rule);
+  }
+
+  /**
+   * \param key The classification key parsed from the packet
+   * \return The class of the packet
+   */
+  uint32_t Classify(const FlowKey& key) const
+  {
+    if (!(key.flags & FlowKey::PORTS))
+    {
+      return 0;
+    }
+    std::vector<Rule>::const_iterator it = std::lower_bound(
+        m_rules.begin(), m_rules.end(), Rule(key.destinationPort, 0));
+    return (it != m_rules.end() && it->first == key.destinationPort)
+               ? it->second
+               : 0;
+  }
+
+private:
+  typedef std::pair<uint16_t, uint32_t> Rule; //!< port and class
+  std::vector<Rule> m_rules;                  //!< sorted by port
+};
+
+/**
+ * \ingroup diffserv
+ * \brief Classifier policy mapping DSCP codepoints to classes
+ *
+ * A 64-entry table indexed by the codepoint; non-IPv4 packets and
+ * unmapped codepoints go to class 0.
+ */
+class DscpClassifier
+{
+public:
+  DscpClassifier()
+  {
+    std::fill(m_table, m_table + 64, 0);
+  }
+
+  /**
+   * \brief Map a codepoint to a class
+   * \param dscp The codepoint, 0 to 63
+   * \param classIndex The class
+   */
+  void Add(uint8_t dscp, uint32_t classIndex)
+  {
+    NS_ASSERT(dscp < 64);
+    m_table[dscp] = classIndex;
+  }
+
+  /**
+   * \param key The classification key parsed from the packet
+   * \return The class of the packet
+   */
+  uint32_t Classify(const FlowKey& key) const
+  {
+    return (key.flags & FlowKey::IPV4) ? m_table[key.dscp & 63] : 0;
+  }
+
+private:
+  uint32_t m_table[64]; //!< class by codepoint
+};
+
+/**
+ * \ingroup diffserv
+ * \brief Scheduler policy serving the highest priority backlogged class
+ *
+ * Lower priority values are served first, equal values in class order.
+ * Classes are ranked once, when their priorities are set, and a bitmap of
+ * backlogged ranks yields the class to serve with one find-first-set; at
+ * most 64 classes are supported.
+ */
+class StrictPriorityScheduler
+{
+public:
+  /// Most classes a scheduler instance supports
+  static const uint32_t MAX_CLASSES = 64;
+
+  StrictPriorityScheduler() : m_priorities(), m_rankToClass(), m_classToRank(),
+                              m_backlogged(0)
+  {
+  }
+
+  /**
+   * \brief Set the number of classes, all with priority 0
+   * \param nClasses The number of classes
+   */
+  void SetNClasses(uint32_t nClasses)
+  {
+    NS_ASSERT(nClasses <= MAX_CLASSES);
+    m_priorities.assign(nClasses, 0);
+    Rank();
+  }
+
+  /**
+   * \brief Set the priority of a class; its queue must be empty
+   * \param classIndex The class
+   * \param priority The priority, lower is served first
+   */
+  void SetPriority(uint32_t classIndex, uint32_t priority)
+  {
+    m_priorities[classIndex] = priority;
+    Rank();
+  }
+
+  /**
+   * \brief Note that a class became backlogged
+   * \param classIndex The class
+   */
+  void NotifyBacklogged(uint32_t classIndex)
+  {
+    m_backlogged |= uint64_t(1) << m_classToRank[classIndex];
+  }
+
+  /**
+   * \brief Select the class to serve
+   * \param queues The per-class queues, indexable by class
+   * \return The class, or queues.size() if none is backlogged
+   */
+  template <typename Queues>
+  uint32_t Select(const Queues& queues)
+  {
+    if (m_backlogged == 0)
+    {
+      return queues.size();
+    }
+    return m_rankToClass[__builtin_ctzll(m_backlogged)];
+  }
+
+  /**
+   * \brief Note that a packet of the selected class was sent
+   * \param classIndex The class
+   * \param size The packet size
+   * \param empty True if the class has no packet left
+   */
+  void NotifyServed(uint32_t classIndex, uint32_t size, bool empty)
+  {
+    if (empty)
+    {
+      m_backlogged &= ~(uint64_t(1) << m_classToRank[classIndex]);
+    }
+  }
+
+private:
+  /**
+   * \brief Rank the classes by priority
+   */
+  void Rank(void)
+  {
+    uint32_t nClasses = m_priorities.size();
+    m_rankToClass.resize(nClasses);
+    m_classToRank.resize(nClasses);
+    for (uint32_t i = 0; i < nClasses; i++)
+    {
+      m_rankToClass[i] = i;
+    }
+    const std::vector<uint32_t>& priorities = m_priorities;
+    std::stable_sort(m_rankToClass.begin(), m_rankToClass.end(),
+                     [&priorities](uint32_t a, uint32_t b) {
+                       return priorities[a] < priorities[b];
+                     });
+    for (uint32_t rank = 0; rank < nClasses; rank++)
+    {
+      m_classToRank[m_rankToClass[rank]] = rank;
+    }
+    m_backlogged = 0;
+  }
+
+  std::vector<uint32_t> m_priorities;  //!< priority by class
+  std::vector<uint32_t> m_rankToClass; //!< class by rank
+  std::vector<uint32_t> m_classToRank; //!< rank by class
+  uint64_t m_backlogged;               //!< one bit per backlogged rank
+};
+
+/**
+ * \ingroup diffserv
+ * \brief Scheduler policy sharing the link by deficit round robin
+ *
+ * Backlogged classes wait in an active list.  The class at its front is
+ * credited its quantum once per turn and is served while its deficit
+ * covers its head packet; it then moves to the back of the list, or
+ * leaves it with a zero deficit once empty.
+ */
+class DeficitRoundRobinScheduler
+{
+public:
+  DeficitRoundRobinScheduler() : m_quanta(), m_deficits(), m_activeList(),
+                                 m_credited(false)
+  {
+  }
+
+  /**
+   * \brief Set the number of classes, all with a zero quantum
+   * \param nClasses The number of classes
+   */
+  void SetNClasses(uint32_t nClasses)
+  {
+    m_quanta.assign(nClasses, 0);
+    m_deficits.assign(nClasses, 0);
+    m_activeList.clear();
+    m_credited = false;
+  }
+
+  /**
+   * \brief Set the quantum of a class
+   * \param classIndex The class
+   * \param quantum The quantum in bytes, at least 1
+   */
+  void SetQuantum(uint32_t classIndex, uint32_t quantum)
+  {
+    NS_ASSERT(quantum > 0);
+    m_quanta[classIndex] = quantum;
+  }
+
+  /**
+   * \brief Note that a class became backlogged
+   *
+   * The class must have a quantum: Select would otherwise never find a
+   * deficit covering its head packet.
+   *
+   * \param classIndex The class
+   */
+  void NotifyBacklogged(uint32_t classIndex)
+  {
+    NS_ASSERT_MSG(m_quanta[classIndex] > 0,
+                  "Class " << classIndex << " backlogged without a quantum");
+    m_activeList.push_back(classIndex);
+  }
+
+  /**
+   * \brief Select the class to serve
+   *
+   * Moves the round forward to the first class whose deficit covers its
+   * head packet; selecting again without serving returns the same class.
+   *
+   * \param queues The per-class queues, indexable by class
+   * \return The class, or queues.size() if none is backlogged
+   */
+  template <typename Queues>
+  uint32_t Select(const Queues& queues)
+  {
+    while (!m_activeList.empty())
+    {
+      uint32_t classIndex = m_activeList.front();
+      if (!m_credited)
+      {
+        m_deficits[classIndex] += m_quanta[classIndex];
+        m_credited = true;
+      }
+      if (queues[classIndex].Front().size <= m_deficits[classIndex])
+      {
+        return classIndex;
+      }
+      m_activeList.pop_front();
+      m_activeList.push_back(classIndex);
+      m_credited = false;
+    }
+    return queues.size();
+  }
+
+  /**
+   * \brief Note that a packet of the selected class was sent
+   * \param classIndex The class
+   * \param size The packet size
+   * \param empty True if the class has no packet left
+   */
+  void NotifyServed(uint32_t classIndex, uint32_t size, bool empty)
+  {
+    m_deficits[classIndex] -= size;
+    if (empty)
+    {
+      m_activeList.pop_front();
+      m_deficits[classIndex] = 0;
+      m_credited = false;
+    }
+  }
+
+private:
+  std::vector<uint32_t> m_quanta;   //!< quantum by class
+  std::vector<uint32_t> m_deficits; //!< deficit by class
+  std::deque<uint32_t> m_activeList; //!< backlogged classes, front served
+  bool m_credited;                  //!< front class got its quantum
+};
+
+/**
+ * \ingroup diffserv
+ * \brief Buffer policy bounding every class to a number of packets
+ *
+ * The aggregate bound is left to the queue that owns the core.
+ */
+class TailDropBuffer
+{
+public:
+  TailDropBuffer() : m_maxPackets(100)
+  {
+  }
+
+  /**
+   * \brief Set the packet limit of every class
+   * \param maxPackets The limit
+   */
+  void SetMaxPackets(uint32_t maxPackets)
+  {
+    m_maxPackets = maxPackets;
+  }
+
+  /**
+   * \return The packet limit of every class
+   */
+  uint32_t GetMaxPackets(void) const
+  {
+    return m_maxPackets;
+  }
+
+  /**
+   * \brief Check whether an arrival may join its class
+   * \param classPackets The packets stored in the class
+   * \param classBytes The bytes stored in the class
+   * \param size The size of the arrival
+   * \return True to admit the packet
+   */
+  bool Admit(uint32_t classPackets, uint32_t classBytes, uint32_t size) const
+  {
+    return classPackets < m_maxPackets;
+  }
+
+private:
+  uint32_t m_maxPackets; //!< packet limit per class
+};
+
+}
+
+#endif
@@ -0,0 +1,305 @@
+#include "diffserv-queue-disc.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/log.h"
+#include "ns3/pointer.h"
+#include <iterator>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DiffServQueueDisc");
+NS_OBJECT_ENSURE_REGISTERED(DiffServItemQueue);
+NS_OBJECT_ENSURE_REGISTERED(DiffServQueueDisc);
+
+TypeId DiffServItemQueue::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::DiffServItemQueue")
+                          .SetParent<Queue<QueueDiscItem>>()
+                          .SetGroupName("TrafficControl")
+                          .AddConstructor<DiffServItemQueue>();
+  return tid;
+}
+
+DiffServItemQueue::DiffServItemQueue()
+    : Queue<QueueDiscItem>(), m_diffServ(0), m_removed(0), m_items()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+DiffServItemQueue::~DiffServItemQueue()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void DiffServItemQueue::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  SetDiffServ(0);
+  Queue<QueueDiscItem>::DoDispose();
+}
+
+void DiffServItemQueue::SetDiffServ(Ptr<DiffServ> diffServ)
+{
+  NS_LOG_FUNCTION(this << diffServ);
+  NS_ASSERT_MSG(IsEmpty(), "Cannot change the DiffServ queue of a busy queue");
+
+  if (m_diffServ)
+  {
+    m_diffServ->TraceDisconnectWithoutContext(
+        "DropAfterDequeue",
+        MakeCallback(&DiffServItemQueue::DiffServDropped, this));
+  }
+  m_diffServ = diffServ;
+  m_removed = 0;
+  m_items.clear();
+  if (m_diffServ)
+  {
+    // Items are never larger than the packets DiffServ stores for them
+    SetMaxSize(m_diffServ->GetMaxSize());
+    m_diffServ->TraceConnectWithoutContext(
+        "DropAfterDequeue",
+        MakeCallback(&DiffServItemQueue::DiffServDropped, this));
+  }
+}
+
+bool DiffServItemQueue::Enqueue(Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION(this << item);
+
+  Ptr<Packet> p = item->GetPacket();
+  Ptr<Ipv4QueueDiscItem> ipv4Item = DynamicCast<Ipv4QueueDiscItem>(item);
+  if (ipv4Item)
+  {
+    p->AddHeader(ipv4Item->GetHeader());
+  }
+  bool enqueued = m_diffServ->Enqueue(p);
+
+  // The item is accounted at its own size, which counts the header apart
+  Ipv4Header header;
+  if (ipv4Item)
+  {
+    p->RemoveHeader(header);
+  }
+  if (!enqueued)
+  {
+    NS_LOG_LOGIC("DiffServ refused the packet");
+    DropBeforeEnqueue(item);
+    return false;
+  }
+  bool accounted = DoEnqueue(GetContainer().end(), item);
+  NS_ASSERT_MSG(accounted, "DiffServ and the item queue disagree on MaxSize");
+  if (ipv4Item)
+  {
+    p->AddHeader(header);
+  }
+  m_items[PeekPointer(p)] = std::prev(GetContainer().end());
+  return true;
+}
+
+Ptr<QueueDiscItem> DiffServItemQueue::Dequeue(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  Ptr<Packet> p = m_diffServ->Dequeue();
+  return p ? TakeItem(p) : 0;
+}
+
+Ptr<QueueDiscItem> DiffServItemQueue::Remove(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  // DiffServ reports the drop to DiffServDropped, which drops the item
+  m_removed = 0;
+  if (!m_diffServ->Remove())
+  {
+    return 0;
+  }
+  NS_ASSERT_MSG(m_removed, "Packet not accounted in the item queue");
+  Ptr<QueueDiscItem> item = m_removed;
+  m_removed = 0;
+  return item;
+}
+
+Ptr<const QueueDiscItem> DiffServItemQueue::Peek(void) const
+{
+  NS_LOG_FUNCTION(this);
+
+  Ptr<const Packet> p = m_diffServ->Peek();
+  if (!p)
+  {
+    return 0;
+  }
+  std::unordered_map<const Packet*, ConstIterator>::const_iterator it =
+      m_items.find(PeekPointer(p));
+  NS_ASSERT_MSG(it != m_items.end(), "Packet not accounted in the item queue");
+  return *it->second;
+}
+
+Ptr<QueueDiscItem> DiffServItemQueue::TakeItem(Ptr<Packet> p)
+{
+  std::unordered_map<const Packet*, ConstIterator>::iterator it =
+      m_items.find(PeekPointer(p));
+  NS_ASSERT_MSG(it != m_items.end(), "Packet not accounted in the item queue");
+  ConstIterator pos = it->second;
+  m_items.erase(it);
+
+  Ipv4Header header;
+  bool ipv4 = StripHeader(*pos, header);
+  Ptr<QueueDiscItem> item = DoDequeue(pos);
+  if (!ipv4)
+  {
+    return item;
+  }
+
+  // Carry over what DiffServ marked in the header
+  Ptr<Ipv4QueueDiscItem> ipv4Item = StaticCast<Ipv4QueueDiscItem>(item);
+  const Ipv4Header& original = ipv4Item->GetHeader();
+  if (header.GetDscp() != original.GetDscp())
+  {
+    // The item has no way to re-mark its header
+    Ptr<Ipv4QueueDiscItem> marked = Create<Ipv4QueueDiscItem>(
+        p, item->GetAddress(), item->GetProtocol(), header);
+    marked->SetTxQueueIndex(item->GetTxQueueIndex());
+    marked->SetTimeStamp(item->GetTimeStamp());
+    return marked;
+  }
+  if (header.GetEcn() == Ipv4Header::ECN_CE &&
+      original.GetEcn() != Ipv4Header::ECN_CE)
+  {
+    ipv4Item->Mark();
+  }
+  return item;
+}
+
+bool DiffServItemQueue::StripHeader(Ptr<QueueDiscItem> item,
+                                    Ipv4Header& header)
+{
+  if (!DynamicCast<Ipv4QueueDiscItem>(item))
+  {
+    return false;
+  }
+  item->GetPacket()->RemoveHeader(header);
+  return true;
+}
+
+void DiffServItemQueue::DiffServDropped(Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << p);
+
+  std::unordered_map<const Packet*, ConstIterator>::iterator it =
+      m_items.find(PeekPointer(p));
+  if (it == m_items.end())
+  {
+    // Dequeued or removed through this queue, already taken
+    return;
+  }
+  ConstIterator pos = it->second;
+  m_items.erase(it);
+  Ipv4Header header;
+  StripHeader(*pos, header);
+  m_removed = DoRemove(pos);
+}
+
+TypeId DiffServQueueDisc::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::DiffServQueueDisc")
+          .SetParent<QueueDisc>()
+          .SetGroupName("TrafficControl")
+          .AddConstructor<DiffServQueueDisc>()
+          .AddAttribute("DiffServ",
+                        "The DiffServ queue (SPQ, DRR, ...) classifying and "
+                        "scheduling the packets",
+                        PointerValue(),
+                        MakePointerAccessor(&DiffServQueueDisc::SetDiffServ,
+                                            &DiffServQueueDisc::GetDiffServ),
+                        MakePointerChecker<DiffServ>());
+  return tid;
+}
+
+DiffServQueueDisc::DiffServQueueDisc()
+    : QueueDisc(QueueDiscSizePolicy::NO_LIMITS), m_diffServ(0)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+DiffServQueueDisc::~DiffServQueueDisc()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void DiffServQueueDisc::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  if (m_diffServ)
+  {
+    m_diffServ->SetWakeCallback(DiffServ::WakeCallback());
+  }
+  m_diffServ = 0;
+  QueueDisc::DoDispose();
+}
+
+void DiffServQueueDisc::SetDiffServ(Ptr<DiffServ> diffServ)
+{
+  NS_LOG_FUNCTION(this << diffServ);
+  m_diffServ = diffServ;
+}
+
+Ptr<DiffServ> DiffServQueueDisc::GetDiffServ(void) const
+{
+  return m_diffServ;
+}
+
+bool DiffServQueueDisc::DoEnqueue(Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION(this << item);
+  // Drops are reported by the internal queue traces
+  return GetInternalQueue(0)->Enqueue(item);
+}
+
+Ptr<QueueDiscItem> DiffServQueueDisc::DoDequeue(void)
+{
+  NS_LOG_FUNCTION(this);
+  return GetInternalQueue(0)->Dequeue();
+}
+
+bool DiffServQueueDisc::CheckConfig(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  if (!m_diffServ)
+  {
+    NS_LOG_ERROR("DiffServQueueDisc needs a DiffServ queue");
+    return false;
+  }
+  if (m_diffServ->GetNTrafficClasses() == 0)
+  {
+    NS_LOG_ERROR("The DiffServ queue has no traffic class");
+    return false;
+  }
+  if (GetNQueueDiscClasses() > 0 || GetNPacketFilters() > 0)
+  {
+    NS_LOG_ERROR("DiffServQueueDisc classifies and schedules by itself: no "
+                 "queue disc classes or packet filters allowed");
+    return false;
+  }
+  if (GetNInternalQueues() > 0)
+  {
+    NS_LOG_ERROR("DiffServQueueDisc provides its own internal queue");
+    return false;
+  }
+
+  Ptr<DiffServItemQueue> queue = CreateObject<DiffServItemQueue>();
+  queue->SetDiffServ(m_diffServ);
+  AddInternalQueue(queue);
+  return true;
+}
+
+void DiffServQueueDisc::InitializeParams(void)
+{
+  NS_LOG_FUNCTION(this);
+  // Held packets restart the queue disc, which stops when nothing is sent
+  m_diffServ->SetWakeCallback(MakeCallback(&QueueDisc::Run, this));
+}
+
+}
@@ -0,0 +1,135 @@
+#ifndef DIFFSERV_QUEUE_DISC_H
+#define DIFFSERV_QUEUE_DISC_H
+
+#include "diffserv.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/queue-disc.h"
+#include "ns3/queue.h"
+#include <unordered_map>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Queue of queue disc items ordered by a DiffServ queue
+ *
+ * The items are kept in the Queue<QueueDiscItem> base, whose traces feed
+ * the statistics of the owning queue disc, while the DiffServ queue holds
+ * their packets and decides which one leaves next.  DiffServ stores the
+ * packet of the item itself, not a copy: the IPv4 header of an IPv4 item
+ * is added to its packet while it is queued, as the device would see it,
+ * so that classification, ECN marking and DSCP re-marking work unchanged.
+ * On the way out the header is taken back and a CE mark is carried over
+ * with QueueDiscItem::Mark; only a re-marked DSCP needs a new item.
+ *
+ * Packets that DiffServ drops after storing them (AQM, pushout, Remove)
+ * are dropped from this queue as well.
+ */
+class DiffServItemQueue : public Queue<QueueDiscItem>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  DiffServItemQueue();
+  virtual ~DiffServItemQueue();
+
+  /**
+   * \brief Set the DiffServ queue ordering the items
+   * \param diffServ The queue; its MaxSize bounds this queue too
+   */
+  void SetDiffServ(Ptr<DiffServ> diffServ);
+
+  virtual bool Enqueue(Ptr<QueueDiscItem> item) override;
+  virtual Ptr<QueueDiscItem> Dequeue(void) override;
+  virtual Ptr<QueueDiscItem> Remove(void) override;
+  virtual Ptr<const QueueDiscItem> Peek(void) const override;
+
+protected:
+  virtual void DoDispose(void) override;
+
+private:
+  /**
+   * \brief Take the item of a packet leaving the DiffServ queue
+   * \param p The packet
+   * \return The item, with the marks DiffServ left in the packet header
+   */
+  Ptr<QueueDiscItem> TakeItem(Ptr<Packet> p);
+
+  /**
+   * \brief Take the IPv4 header DiffServ saw back out of an item's packet
+   * \param item The item
+   * \param header Receives the header, as DiffServ left it
+   * \return False if the item is not an IPv4 item
+   */
+  static bool StripHeader(Ptr<QueueDiscItem> item, Ipv4Header& header);
+
+  /**
+   * \brief Drop the item of a packet that DiffServ dropped after storing it
+   * \param p The packet
+   */
+  void DiffServDropped(Ptr<const Packet> p);
+
+  Ptr<DiffServ> m_diffServ;     //!< holds the packets and schedules them
+  Ptr<QueueDiscItem> m_removed; //!< item of the last packet DiffServ dropped
+  /// Position of the item of every packet stored in m_diffServ
+  std::unordered_map<const Packet*, ConstIterator> m_items;
+};
+
+/**
+ * \ingroup diffserv
+ * \brief DiffServ as a root queue disc of the traffic control layer
+ *
+ * Installed with TrafficControlHelper in place of a DiffServ device
+ * TxQueue.  The DiffServ queue (SPQ, DRR or any other subclass, with its
+ * traffic classes and filters) is given by the DiffServ attribute; the
+ * queue disc stores its packets through a DiffServItemQueue.  The traffic
+ * control layer then provides requeueing, the device's flow control and
+ * byte queue limits, so that the device queue can stay at a packet or two
+ * while DiffServ decides the order and the latency of the backlog.
+ *
+ * Packets held by shapers or ceilings wake the queue disc up through the
+ * DiffServ wake callback.  A DiffServ queue serves one queue disc at most.
+ */
+class DiffServQueueDisc : public QueueDisc
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  DiffServQueueDisc();
+  virtual ~DiffServQueueDisc();
+
+  /**
+   * \brief Set the DiffServ queue classifying and scheduling the packets
+   * \param diffServ The queue; set before the queue disc is initialized
+   */
+  void SetDiffServ(Ptr<DiffServ> diffServ);
+
+  /**
+   * \return The DiffServ queue classifying and scheduling the packets
+   */
+  Ptr<DiffServ> GetDiffServ(void) const;
+
+protected:
+  virtual void DoDispose(void) override;
+
+private:
+  virtual bool DoEnqueue(Ptr<QueueDiscItem> item) override;
+  virtual Ptr<QueueDiscItem> DoDequeue(void) override;
+  virtual bool CheckConfig(void) override;
+  virtual void InitializeParams(void) override;
+
+  Ptr<DiffServ> m_diffServ; //!< classifies and schedules the packets
+};
+
+}
+
+#endif
@@ -9,10 +9,13 @@
 #include "ns3/traffic-control-module.h"
 
 #include "dest-port-filter.h"
+#include "diffserv-queue-disc.h"
 #include "diffserv.h"
 #include "drr.h"
 #include "filter.h"
+#include "multi-queue-diffserv.h"
 #include "spq.h"
+#include "static-diffserv.h"
 #include "traffic-class.h"
 
 #include <fstream>
@@ -39,6 +42,10 @@ static uint16_t g_appCPort_DRR;
 
 static double g_plotBinInterval = 0.5;
 static double g_simDuration = 40.0;
+static bool g_staticQueues = false;
+static bool g_queueDisc = false;
+static bool g_multiQueue = false;
+static Ptr<MultiQueueDiffServ> g_multiQueueDiffServ;
 
 void WriteDefaultConfigFile(const std::string& filename,
                             const std::string& content)
@@ -56,6 +63,59 @@ void WriteDefaultConfigFile(const std::string& filename,
   }
 }
 
+void AttachDiffServ(Ptr<NetDevice> device, Ptr<DiffServ> diffServ)
+{
+  if (!g_queueDisc)
+  {
+    device->SetAttribute("TxQueue", PointerValue(diffServ));
+    return;
+  }
+
+  // DiffServ replaces the default root queue disc; the device queue only
+  // needs to cover the byte queue limit
+  NS_LOG_INFO("Installing DiffServ as the root queue disc");
+  TrafficControlHelper tch;
+  tch.Uninstall(device);
+  tch.SetRootQueueDisc("ns3::DiffServQueueDisc", "DiffServ",
+                       PointerValue(diffServ));
+  tch.SetQueueLimits("ns3::DynamicQueueLimits");
+  tch.Install(device);
+  device->GetObject<PointToPointNetDevice>()->GetQueue()->SetMaxSize(
+      QueueSize("5p"));
+}
+
+void AttachMultiQueueDiffServ(Ptr<NetDevice> device,
+                              MultiQueueDiffServ::Factory factory)
+{
+  g_multiQueueDiffServ = CreateObject<MultiQueueDiffServ>();
+  g_multiQueueDiffServ->SetFactory(factory);
+  uint32_t nQueues = g_multiQueueDiffServ->Install(device);
+  NS_LOG_INFO("Installed " << nQueues << " DiffServ queues on the device");
+  device->GetObject<PointToPointNetDevice>()->GetQueue()->SetMaxSize(
+      QueueSize("5p"));
+}
+
+void PrintMultiQueueStats(void)
+{
+  MultiQueueDiffServ::PortStats port = g_multiQueueDiffServ->GetPortStats();
+  std::cout << "Port: " << g_multiQueueDiffServ->GetNQueues() << " queues, "
+            << port.nTotalReceivedPackets << " packets received, "
+            << port.nTotalDroppedPackets << " dropped, " << port.nPackets
+            << " queued" << std::endl;
+
+  Ptr<DiffServ> first = g_multiQueueDiffServ->GetQueue(0);
+  for (uint32_t i = 0; i < first->GetNTrafficClasses(); i++)
+  {
+    MultiQueueDiffServ::ClassStats stats =
+        g_multiQueueDiffServ->GetClassStats(i);
+    uint64_t aqmDrops = stats.nAqmEnqueueDrops + stats.nAqmDequeueDrops;
+    std::cout << "Class " << i << ": " << stats.nPackets << " queued, "
+              << stats.nTailDrops << " tail drops, " << stats.nOverflowDrops
+              << " overflow drops, " << aqmDrops << " AQM drops, "
+              << stats.nEcnMarks << " ECN marks" << std::endl;
+  }
+}
+
 void CreateTopology(NodeContainer& nodes, NetDeviceContainer& p2pDevices,
                     InternetStackHelper& stack, Ipv4AddressHelper& address,
                     Ipv4InterfaceContainer& routerInterfaces,
@@ -92,18 +152,8 @@ void CreateTopology(NodeContainer& nodes, NetDeviceContainer& p2pDevices,
   Ipv4GlobalRoutingHelper::PopulateRoutingTables();
 }
 
-void SetupSPQValidation(NodeContainer& nodes,
-                        Ipv4InterfaceContainer& sinkNodeInterface,
-                        std::string configFile, ApplicationContainer& apps,
-                        Ptr<FlowMonitor>& flowMonitorInstance,
-                        FlowMonitorHelper& localFlowHelper, bool useCiscoConfig)
+Ptr<DiffServ> CreateValidationSPQ(std::string configFile, bool useCiscoConfig)
 {
-  NS_LOG_INFO("Setting up SPQ validation scenario");
-
-  g_appBPort_SPQ = portBase;
-  g_appAPort_SPQ = portBase + 1;
-
-  Ptr<Node> router = nodes.Get(1);
   Ptr<SPQ> spq = CreateObject<SPQ>();
 
   if (useCiscoConfig)
@@ -142,8 +192,98 @@ void SetupSPQValidation(NodeContainer& nodes,
   lowFilter->AddFilterElement(CreateObject<DestPortFilter>(g_appBPort_SPQ));
   lowPriorityClass->AddFilter(lowFilter);
 
+  return spq;
+}
+
+void AttachStaticSPQ(Ptr<NetDevice> device, std::string configFile)
+{
+  NS_LOG_INFO("Using the compile-time specialized SPQ");
+  Ptr<StaticSPQ> staticSpq = CreateObject<StaticSPQ>();
+  if (!staticSpq->SetConfigFile(configFile))
+  {
+    NS_FATAL_ERROR("Failed to set StaticSPQ config file: " << configFile);
+  }
+  staticSpq->AddPortRule(g_appAPort_SPQ, 0);
+  staticSpq->AddPortRule(g_appBPort_SPQ, 1);
+  device->SetAttribute("TxQueue", PointerValue(staticSpq));
+}
+
+Ptr<DiffServ> CreateValidationDRR(std::string configFile)
+{
+  Ptr<DRR> drr = CreateObject<DRR>();
+
+  NS_ASSERT_MSG(!configFile.empty(), "DRR config file must be provided.");
+  if (!drr->SetConfigFile(configFile))
+  {
+    NS_FATAL_ERROR("Failed to set DRR config file: " << configFile);
+  }
+
+  NS_ASSERT_MSG(drr->GetNTrafficClasses() >= 3,
+                "DRR config did not create at least 3 queues for validation.");
+
+  Ptr<TrafficClass> classA = drr->GetTrafficClass(0);
+  NS_ASSERT_MSG(classA, "Could not get DRR traffic class 0.");
+  Ptr<Filter> filterA = CreateObject<Filter>();
+  filterA->AddFilterElement(CreateObject<DestPortFilter>(g_appAPort_DRR));
+  classA->AddFilter(filterA);
+
+  Ptr<TrafficClass> classB = drr->GetTrafficClass(1);
+  NS_ASSERT_MSG(classB, "Could not get DRR traffic class 1.");
+  Ptr<Filter> filterB = CreateObject<Filter>();
+  filterB->AddFilterElement(CreateObject<DestPortFilter>(g_appBPort_DRR));
+  classB->AddFilter(filterB);
+
+  Ptr<TrafficClass> classC = drr->GetTrafficClass(2);
+  NS_ASSERT_MSG(classC, "Could not get DRR traffic class 2.");
+  Ptr<Filter> filterC = CreateObject<Filter>();
+  filterC->AddFilterElement(CreateObject<DestPortFilter>(g_appCPort_DRR));
+  classC->AddFilter(filterC);
+
+  return drr;
+}
+
+void AttachStaticDRR(Ptr<NetDevice> device, std::string configFile)
+{
+  NS_LOG_INFO("Using the compile-time specialized DRR");
+  Ptr<StaticDRR> staticDrr = CreateObject<StaticDRR>();
+  if (!staticDrr->SetConfigFile(configFile))
+  {
+    NS_FATAL_ERROR("Failed to set StaticDRR config file: " << configFile);
+  }
+  staticDrr->AddPortRule(g_appAPort_DRR, 0);
+  staticDrr->AddPortRule(g_appBPort_DRR, 1);
+  staticDrr->AddPortRule(g_appCPort_DRR, 2);
+  device->SetAttribute("TxQueue", PointerValue(staticDrr));
+}
+
+void SetupSPQValidation(NodeContainer& nodes,
+                        Ipv4InterfaceContainer& sinkNodeInterface,
+                        std::string configFile, ApplicationContainer& apps,
+                        Ptr<FlowMonitor>& flowMonitorInstance,
+                        FlowMonitorHelper& localFlowHelper, bool useCiscoConfig)
+{
+  NS_LOG_INFO("Setting up SPQ validation scenario");
+
+  g_appBPort_SPQ = portBase;
+  g_appAPort_SPQ = portBase + 1;
+
+  Ptr<Node> router = nodes.Get(1);
   Ptr<NetDevice> routerEgressDev = router->GetDevice(1);
-  routerEgressDev->SetAttribute("TxQueue", PointerValue(spq));
+  if (g_staticQueues)
+  {
+    AttachStaticSPQ(routerEgressDev, configFile);
+  }
+  else if (g_multiQueue)
+  {
+    AttachMultiQueueDiffServ(routerEgressDev,
+                             MakeBoundCallback(&CreateValidationSPQ,
+                                               configFile, useCiscoConfig));
+  }
+  else
+  {
+    AttachDiffServ(routerEgressDev,
+                   CreateValidationSPQ(configFile, useCiscoConfig));
+  }
 
   BulkSendHelper sourceB(
       "ns3::TcpSocketFactory",
@@ -221,7 +361,7 @@ void SetupSPQValidationFromCisco(NodeContainer& nodes,
   lowPriorityClass->AddFilter(lowFilter);
 
   Ptr<NetDevice> routerEgressDev = router->GetDevice(1);
-  routerEgressDev->SetAttribute("TxQueue", PointerValue(spq));
+  AttachDiffServ(routerEgressDev, spq);
 
   BulkSendHelper sourceB(
       "ns3::TcpSocketFactory",
@@ -274,37 +414,20 @@ void SetupDRRValidation(NodeContainer& nodes,
   g_appCPort_DRR = portBase + 2;
 
   Ptr<Node> router = nodes.Get(1);
-  Ptr<DRR> drr = CreateObject<DRR>();
-
-  NS_ASSERT_MSG(!configFile.empty(), "DRR config file must be provided.");
-  if (!drr->SetConfigFile(configFile))
+  Ptr<NetDevice> routerEgressDev = router->GetDevice(1);
+  if (g_staticQueues)
   {
-    NS_FATAL_ERROR("Failed to set DRR config file: " << configFile);
+    AttachStaticDRR(routerEgressDev, configFile);
+  }
+  else if (g_multiQueue)
+  {
+    AttachMultiQueueDiffServ(
+        routerEgressDev, MakeBoundCallback(&CreateValidationDRR, configFile));
+  }
+  else
+  {
+    AttachDiffServ(routerEgressDev, CreateValidationDRR(configFile));
   }
-
-  NS_ASSERT_MSG(drr->GetNTrafficClasses() >= 3,
-                "DRR config did not create at least 3 queues for validation.");
-
-  Ptr<TrafficClass> classA = drr->GetTrafficClass(0);
-  NS_ASSERT_MSG(classA, "Could not get DRR traffic class 0.");
-  Ptr<Filter> filterA = CreateObject<Filter>();
-  filterA->AddFilterElement(CreateObject<DestPortFilter>(g_appAPort_DRR));
-  classA->AddFilter(filterA);
-
-  Ptr<TrafficClass> classB = drr->GetTrafficClass(1);
-  NS_ASSERT_MSG(classB, "Could not get DRR traffic class 1.");
-  Ptr<Filter> filterB = CreateObject<Filter>();
-  filterB->AddFilterElement(CreateObject<DestPortFilter>(g_appBPort_DRR));
-  classB->AddFilter(filterB);
-
-  Ptr<TrafficClass> classC = drr->GetTrafficClass(2);
-  NS_ASSERT_MSG(classC, "Could not get DRR traffic class 2.");
-  Ptr<Filter> filterC = CreateObject<Filter>();
-  filterC->AddFilterElement(CreateObject<DestPortFilter>(g_appCPort_DRR));
-  classC->AddFilter(filterC);
-
-  Ptr<NetDevice> routerEgressDev = router->GetDevice(1);
-  routerEgressDev->SetAttribute("TxQueue", PointerValue(drr));
 
   ApplicationContainer sourceAppsLocal, sinkAppsLocal;
 
@@ -628,11 +751,41 @@ int main(int argc, char* argv[])
                configFile);
   cmd.AddValue("cisco", "Use Cisco configuration format for SPQ (extra credit)",
                useCiscoConfig);
+  cmd.AddValue("static",
+               "Use the compile-time specialized StaticSPQ/StaticDRR queues",
+               g_staticQueues);
+  cmd.AddValue("queueDisc",
+               "Install DiffServ as a traffic control queue disc instead of "
+               "the device TxQueue",
+               g_queueDisc);
+  cmd.AddValue("multiQueue",
+               "Install one DiffServ queue per device transmission queue "
+               "with MultiQueueDiffServ and print its port statistics",
+               g_multiQueue);
   cmd.AddValue("simTime", "Total simulation time in seconds", g_simDuration);
   cmd.AddValue("plotInterval", "Interval for collecting plot data in seconds",
                g_plotBinInterval);
   cmd.Parse(argc, argv);
 
+  if (g_staticQueues && g_queueDisc)
+  {
+    NS_LOG_ERROR("The static queues are device TxQueues: --static and "
+                 "--queueDisc cannot be combined.");
+    return 1;
+  }
+  if (g_staticQueues && g_multiQueue)
+  {
+    NS_LOG_ERROR("The static queues are device TxQueues: --static and "
+                 "--multiQueue cannot be combined.");
+    return 1;
+  }
+  if (g_staticQueues && useCiscoConfig)
+  {
+    NS_LOG_ERROR("The static queues read no Cisco configuration: --static "
+                 "and --cisco cannot be combined.");
+    return 1;
+  }
+
   std::string spq_default_config_content = "2\n0\n1\n";
   std::string drr_default_config_content = "3\n300\n200\n100\n";
 
@@ -776,6 +929,11 @@ int main(int argc, char* argv[])
   }
   GenerateThroughputPlot(g_flowHelper, plotFileTag + "-throughput",
                          (mode == "spq"));
+  if (g_multiQueueDiffServ)
+  {
+    PrintMultiQueueStats();
+    g_multiQueueDiffServ = 0;
+  }
 
   Simulator::Destroy();
   NS_LOG_INFO("Simulation destroyed.");
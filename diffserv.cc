@@ -1,9 +1,14 @@
 #include "diffserv.h"
+#include "compiled-classifier.h"
+#include "ns3/boolean.h"
 #include "ns3/enum.h"
 #include "ns3/log.h"
+#include "ns3/nstime.h"
 #include "ns3/pointer.h"
+#include "ns3/simulator.h"
 #include "ns3/uinteger.h"
 #include "traffic-class.h"
+#include <iterator>
 
 namespace ns3
 {
@@ -19,15 +24,85 @@ TypeId DiffServ::GetTypeId(void)
           .SetGroupName("Network")
           .AddAttribute(
               "MaxSize",
-              "The maximum number of packets accepted by this DiffServ queue.",
+              "The maximum number of packets or bytes shared by all traffic "
+              "classes of this DiffServ queue.",
               QueueSizeValue(QueueSize("100p")),
               MakeQueueSizeAccessor(&QueueBase::SetMaxSize,
                                     &QueueBase::GetMaxSize),
-              MakeQueueSizeChecker());
+              MakeQueueSizeChecker())
+          .AddAttribute("DynamicThresholds",
+                        "Admit packets to a traffic class only while its "
+                        "occupancy is within its Alpha times the free part "
+                        "of MaxSize. Per-class MaxPackets and MaxBytes still "
+                        "apply as hard limits. Classes with UseEcn admit "
+                        "ECN-capable packets above their threshold marked CE.",
+                        BooleanValue(false),
+                        MakeBooleanAccessor(&DiffServ::m_dynamicThresholds),
+                        MakeBooleanChecker())
+          .AddAttribute("OverflowPolicy",
+                        "What happens to an arrival that finds MaxSize "
+                        "reached: it is dropped (TailDrop), or stored "
+                        "packets make room for it from the lowest priority "
+                        "class (Pushout), the tail of the longest class "
+                        "(LongestQueueDrop) or the head of the longest class "
+                        "(DropFromFront).",
+                        EnumValue(DiffServ::OVERFLOW_TAIL_DROP),
+                        MakeEnumAccessor(&DiffServ::m_overflowPolicy),
+                        MakeEnumChecker(
+                            DiffServ::OVERFLOW_TAIL_DROP, "TailDrop",
+                            DiffServ::OVERFLOW_PUSHOUT, "Pushout",
+                            DiffServ::OVERFLOW_LONGEST_QUEUE_DROP,
+                            "LongestQueueDrop",
+                            DiffServ::OVERFLOW_DROP_FROM_FRONT,
+                            "DropFromFront"))
+          .AddAttribute(
+              "CompileRules",
+              "Classify through a compiled lookup structure instead of "
+              "scanning the traffic classes and their filters.",
+              BooleanValue(true), MakeBooleanAccessor(&DiffServ::m_compileRules),
+              MakeBooleanChecker())
+          .AddAttribute("FlowCacheSize",
+                        "The number of flows whose traffic class is cached "
+                        "(0 disables the cache). Only used with CompileRules.",
+                        UintegerValue(1024),
+                        MakeUintegerAccessor(&DiffServ::SetFlowCacheSize,
+                                             &DiffServ::GetFlowCacheSize),
+                        MakeUintegerChecker<uint32_t>())
+          .AddAttribute("FlowCacheHits",
+                        "The number of packets classified from the flow cache",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&DiffServ::GetFlowCacheHits),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("FlowCacheMisses",
+                        "The number of packets that missed the flow cache",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&DiffServ::GetFlowCacheMisses),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("FlowCacheEvictions",
+                        "The number of flows evicted from the flow cache",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&DiffServ::GetFlowCacheEvictions),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("ReleaseGranularity",
+                        "The tick of the wheel releasing packets held by "
+                        "shapers and ceilings; release times are rounded up "
+                        "to it.",
+                        TimeValue(MicroSeconds(10)),
+                        MakeTimeAccessor(&DiffServ::SetReleaseGranularity,
+                                         &DiffServ::GetReleaseGranularity),
+                        MakeTimeChecker());
   return tid;
 }
 
-DiffServ::DiffServ() : Queue<Packet>(), m_classes()
+DiffServ::DiffServ()
+    : Queue<Packet>(), m_classes(),
+      m_dynamicThresholds(false), m_overflowPolicy(OVERFLOW_TAIL_DROP),
+      m_compileRules(true),
+      m_compiled(0),
+      m_compiledGeneration(0), m_compiledVersion(0), m_compiledClasses(0),
+      m_schedulingGeneration(0), m_flowCache(),
+      m_wakeCallback(), m_releaseWheel(), m_held(), m_released(),
+      m_wakeAt(Time::Max()), m_wakeEvent(), m_scheduled(0)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -41,6 +116,12 @@ void DiffServ::DoDispose(void)
 {
   NS_LOG_FUNCTION(this);
   m_classes.clear();
+  m_scheduled = 0;
+  m_compiled = 0;
+  m_wakeEvent.Cancel();
+  m_releaseWheel.Clear();
+  m_held.clear();
+  m_wakeCallback = WakeCallback();
   Queue<Packet>::DoDispose();
 }
 
@@ -48,25 +129,177 @@ bool DiffServ::DoEnqueue(Ptr<Packet> p)
 {
   NS_LOG_FUNCTION(this << p);
 
-  if (GetNPackets() >= GetMaxSize().GetValue())
+  FlowKey key = FlowKey::Parse(p);
+  return EnqueueInClass(p, key, SelectClass(key));
+}
+
+uint32_t DiffServ::SelectClass(const FlowKey& key)
+{
+  uint32_t classIndex = Classify(key);
+  if (classIndex >= m_classes.size())
+  {
+    NS_LOG_LOGIC("No matching traffic class, using default (0)");
+    classIndex = 0;
+  }
+  return classIndex;
+}
+
+bool DiffServ::EnqueueInClass(Ptr<Packet> p, const FlowKey& key,
+                              uint32_t classIndex)
+{
+  // The policer, the AQM and the class limits decide first, so that no
+  // packet is pushed out for an arrival they refuse
+  bool congested = false;
+  if (!m_classes[classIndex]->Admit(p, key, congested))
+  {
+    NS_LOG_LOGIC("Traffic class " << classIndex << " refuses packet");
+    DropBeforeEnqueue(p);
+    return false;
+  }
+
+  // Above its threshold, or when the AQM asks for it, an ECN-capable
+  // arrival is kept, and marked CE only once the shared buffer takes it
+  if (m_dynamicThresholds &&
+      !IsWithinDynamicThreshold(m_classes[classIndex], p))
+  {
+    congested = true;
+  }
+  if (congested && !m_classes[classIndex]->CanMarkCongestion(key))
+  {
+    NS_LOG_LOGIC("Traffic class " << classIndex
+                                  << " above its dynamic threshold -- "
+                                     "dropping packet");
+    m_classes[classIndex]->NotifyTailDrop(p);
+    DropBeforeEnqueue(p);
+    return false;
+  }
+
+  if (GetCurrentSize() + p > GetMaxSize() &&
+      (m_overflowPolicy == OVERFLOW_TAIL_DROP || !MakeRoom(classIndex, p)))
   {
     NS_LOG_LOGIC("Queue full -- dropping packet");
+    m_classes[classIndex]->NotifyTailDrop(p);
+    DropBeforeEnqueue(p);
     return false;
   }
 
-  uint32_t classIndex = Classify(p);
-  if (classIndex >= m_classes.size())
+  if (congested)
   {
-    NS_LOG_LOGIC("No matching traffic class, using default (0)");
-    classIndex = 0;
+    m_classes[classIndex]->MarkCongestion(p);
   }
+  bool accounted = Queue<Packet>::DoEnqueue(GetContainer().end(), p);
+  NS_ASSERT_MSG(accounted, "Shared buffer check and base queue disagree");
+  m_classes[classIndex]->Store(p, key, std::prev(GetContainer().end()));
 
-  if (m_classes[classIndex]->Enqueue(p))
+  if (m_classes[classIndex]->GetNPackets() == 1)
   {
-    NS_LOG_LOGIC("Packet enqueued in traffic class " << classIndex);
-    return true;
+    // A wheel entry left from an earlier backlog no longer applies
+    m_held[classIndex] = false;
   }
-  return false;
+
+  NS_LOG_LOGIC("Packet enqueued in traffic class " << classIndex);
+  NotifyEnqueue(classIndex, p);
+  return true;
+}
+
+bool DiffServ::IsWithinDynamicThreshold(const Ptr<TrafficClass>& tClass,
+                                        Ptr<const Packet> p) const
+{
+  QueueSize maxSize = GetMaxSize();
+  double free;
+  double occupancy;
+  if (maxSize.GetUnit() == QueueSizeUnit::BYTES)
+  {
+    free = static_cast<double>(maxSize.GetValue()) - GetNBytes();
+    occupancy = tClass->GetNBytes() + p->GetSize();
+  }
+  else
+  {
+    free = static_cast<double>(maxSize.GetValue()) - GetNPackets();
+    occupancy = tClass->GetNPackets() + 1;
+  }
+
+  NS_LOG_LOGIC("Class occupancy " << occupancy << " threshold "
+                                  << tClass->GetAlpha() * free);
+  return occupancy <= tClass->GetAlpha() * free;
+}
+
+bool DiffServ::MakeRoom(uint32_t classIndex, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << classIndex << p);
+
+  while (GetCurrentSize() + p > GetMaxSize())
+  {
+    uint32_t victim = SelectVictim(classIndex, p);
+    if (victim >= m_classes.size())
+    {
+      NS_LOG_LOGIC("No traffic class gives way");
+      return false;
+    }
+    NS_LOG_LOGIC("Traffic class " << victim << " gives way to class "
+                                  << classIndex);
+    m_classes[victim]->PushOut(m_overflowPolicy == OVERFLOW_DROP_FROM_FRONT);
+  }
+  return true;
+}
+
+uint32_t DiffServ::SelectVictim(uint32_t classIndex,
+                                Ptr<const Packet> p) const
+{
+  uint32_t victim = m_classes.size();
+  if (m_overflowPolicy == OVERFLOW_PUSHOUT)
+  {
+    uint32_t level = m_classes[classIndex]->GetPriorityLevel();
+    for (uint32_t i = 0; i < m_classes.size(); i++)
+    {
+      uint32_t iLevel = m_classes[i]->GetPriorityLevel();
+      if (m_classes[i]->IsEmpty() || iLevel <= level)
+      {
+        continue;
+      }
+      if (victim == m_classes.size() ||
+          iLevel > m_classes[victim]->GetPriorityLevel() ||
+          (iLevel == m_classes[victim]->GetPriorityLevel() &&
+           GetOccupancy(i) > GetOccupancy(victim)))
+      {
+        victim = i;
+      }
+    }
+    return victim;
+  }
+
+  // Longest queue: the arrival counts towards its own class
+  uint32_t longest = GetOccupancy(classIndex) +
+                     ((GetMaxSize().GetUnit() == QueueSizeUnit::BYTES)
+                          ? p->GetSize()
+                          : 1);
+  for (uint32_t i = 0; i < m_classes.size(); i++)
+  {
+    if (i != classIndex && GetOccupancy(i) > longest)
+    {
+      longest = GetOccupancy(i);
+      victim = i;
+    }
+  }
+  return victim;
+}
+
+uint32_t DiffServ::GetOccupancy(uint32_t classIndex) const
+{
+  return (GetMaxSize().GetUnit() == QueueSizeUnit::BYTES)
+             ? m_classes[classIndex]->GetNBytes()
+             : m_classes[classIndex]->GetNPackets();
+}
+
+void DiffServ::DropFromClass(Ptr<Packet> p, ConstIterator position)
+{
+  NS_LOG_FUNCTION(this << p);
+  Queue<Packet>::DoRemove(position);
+}
+
+void DiffServ::NotifyDeparture(ConstIterator position)
+{
+  m_departed = position;
 }
 
 Ptr<Packet> DiffServ::DoDequeue(void)
@@ -79,14 +312,35 @@ Ptr<Packet> DiffServ::DoDequeue(void)
     return 0;
   }
 
-  Ptr<Packet> p = Schedule();
+  Ptr<Packet> p = GetScheduled();
   if (p)
   {
     NS_LOG_LOGIC("Packet dequeued");
+    m_scheduled = 0;
+    Queue<Packet>::DoDequeue(m_scheduledPosition);
   }
   return p;
 }
 
+Ptr<Packet> DiffServ::GetScheduled(void)
+{
+  if (!m_scheduled)
+  {
+    m_scheduled = Schedule();
+    if (m_scheduled)
+    {
+      // The class handing the packet out reported its base queue entry
+      m_scheduledPosition = m_departed;
+    }
+    else if (!IsEmpty())
+    {
+      NS_LOG_LOGIC("All packets held back");
+      WakeForHeldClasses();
+    }
+  }
+  return m_scheduled;
+}
+
 Ptr<Packet> DiffServ::DoPeek(void) const
 {
   NS_LOG_FUNCTION(this);
@@ -97,34 +351,20 @@ Ptr<Packet> DiffServ::DoPeek(void) const
     return 0;
   }
 
-  for (uint32_t i = 0; i < m_classes.size(); i++)
-  {
-    if (!m_classes[i]->IsEmpty())
-    {
-      NS_LOG_LOGIC("Peeking from traffic class " << i);
-      return m_classes[i]->Peek();
-    }
-  }
-
-  NS_LOG_LOGIC("No packet found in peek");
-  return 0;
+  // Peeking takes the scheduling decision that Dequeue would take; the
+  // decision is state of the scheduler rather than of the queue contents
+  return const_cast<DiffServ*>(this)->GetScheduled();
 }
 
 bool DiffServ::IsEmpty(void) const
 {
   NS_LOG_FUNCTION(this);
+  return GetNPackets() == 0;
+}
 
-  for (uint32_t i = 0; i < m_classes.size(); i++)
-  {
-    if (!m_classes[i]->IsEmpty())
-    {
-      NS_LOG_LOGIC("Traffic class " << i << " is not empty");
-      return false;
-    }
-  }
-
-  NS_LOG_LOGIC("All traffic classes are empty");
-  return true;
+void DiffServ::NotifyEnqueue(uint32_t classIndex, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << classIndex << p);
 }
 
 Ptr<Packet> DiffServ::Schedule(void)
@@ -133,10 +373,15 @@ Ptr<Packet> DiffServ::Schedule(void)
 
   for (uint32_t i = 0; i < m_classes.size(); i++)
   {
-    if (!m_classes[i]->IsEmpty())
+    if (!CanServe(i))
+    {
+      continue;
+    }
+    Ptr<Packet> p = m_classes[i]->Dequeue();
+    if (p)
     {
       NS_LOG_LOGIC("Scheduling from traffic class " << i);
-      return m_classes[i]->Dequeue();
+      return p;
     }
   }
 
@@ -147,10 +392,51 @@ Ptr<Packet> DiffServ::Schedule(void)
 uint32_t DiffServ::Classify(Ptr<Packet> p)
 {
   NS_LOG_FUNCTION(this << p);
+  return Classify(FlowKey::Parse(p));
+}
+
+uint32_t DiffServ::Classify(const FlowKey& key)
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (m_compileRules)
+  {
+    RefreshCompiledClassifier();
+  }
+  if (m_compiled)
+  {
+    uint32_t classIndex;
+    if (m_compiled->IsDscpOnly() && (key.flags & FlowKey::IPV4))
+    {
+      classIndex = m_compiled->Classify(key);
+      NS_LOG_LOGIC("DSCP " << static_cast<uint32_t>(key.dscp)
+                           << " maps to traffic class " << classIndex);
+      return (classIndex != CompiledClassifier::NO_MATCH) ? classIndex : 0;
+    }
+
+    if (m_flowCache.Lookup(key, classIndex))
+    {
+      NS_LOG_LOGIC("Flow cached in traffic class " << classIndex);
+      return classIndex;
+    }
+
+    classIndex = m_compiled->Classify(key);
+    if (classIndex != CompiledClassifier::NO_MATCH)
+    {
+      NS_LOG_LOGIC("Packet matches traffic class " << classIndex);
+    }
+    else
+    {
+      NS_LOG_LOGIC("No matching traffic class, using default (0)");
+      classIndex = 0;
+    }
+    m_flowCache.Insert(key, classIndex);
+    return classIndex;
+  }
 
   for (uint32_t i = 0; i < m_classes.size(); i++)
   {
-    if (m_classes[i]->Match(p))
+    if (m_classes[i]->Match(key))
     {
       NS_LOG_LOGIC("Packet matches traffic class " << i);
       return i;
@@ -161,10 +447,89 @@ uint32_t DiffServ::Classify(Ptr<Packet> p)
   return 0;
 }
 
+Ptr<CompiledClassifier> DiffServ::GetCompiledClassifier(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  if (!m_compileRules)
+  {
+    return 0;
+  }
+  RefreshCompiledClassifier();
+  return m_compiled;
+}
+
+void DiffServ::SetCompiledClassifier(Ptr<CompiledClassifier> classifier)
+{
+  NS_LOG_FUNCTION(this << classifier);
+
+  if (!m_compileRules)
+  {
+    NS_LOG_LOGIC("Rule compilation disabled, classifier ignored");
+    return;
+  }
+  m_compiled = classifier;
+  m_compiledGeneration = CompiledClassifier::GetRulesGeneration();
+  m_compiledVersion = GetRulesVersion();
+  m_compiledClasses = m_classes.size();
+  m_flowCache.Clear();
+}
+
+void DiffServ::RefreshCompiledClassifier(void)
+{
+  // The global generation tells cheaply that some rule set changed; only
+  // a change of this queue's own rules calls for recompiling
+  uint64_t generation = CompiledClassifier::GetRulesGeneration();
+  if (generation == m_compiledGeneration &&
+      m_classes.size() == m_compiledClasses)
+  {
+    return;
+  }
+  m_compiledGeneration = generation;
+
+  uint64_t version = GetRulesVersion();
+  if (version == m_compiledVersion && m_classes.size() == m_compiledClasses)
+  {
+    return;
+  }
+  NS_LOG_LOGIC("Rule set changed, recompiling");
+  m_compiled = CompiledClassifier::Compile(m_classes);
+  m_compiledVersion = version;
+  m_compiledClasses = m_classes.size();
+  m_flowCache.Clear();
+}
+
+uint64_t DiffServ::GetRulesVersion(void) const
+{
+  uint64_t version = 0;
+  for (uint32_t i = 0; i < m_classes.size(); i++)
+  {
+    version += m_classes[i]->GetRulesVersion();
+  }
+  return version;
+}
+
 void DiffServ::AddTrafficClass(Ptr<TrafficClass> tClass)
 {
   NS_LOG_FUNCTION(this << tClass);
   m_classes.push_back(tClass);
+  m_held.push_back(false);
+  tClass->SetDropCallback(MakeCallback(&DiffServ::DropFromClass, this));
+  tClass->SetDequeueCallback(MakeCallback(&DiffServ::NotifyDeparture, this));
+  tClass->SetChangeCallback(
+      MakeCallback(&DiffServ::NotifySchedulingChanged, this));
+  m_schedulingGeneration++;
+}
+
+uint64_t DiffServ::GetSchedulingGeneration(void) const
+{
+  return m_schedulingGeneration;
+}
+
+void DiffServ::NotifySchedulingChanged(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_schedulingGeneration++;
 }
 
 Ptr<TrafficClass> DiffServ::GetTrafficClass(uint32_t index) const
@@ -183,6 +548,167 @@ uint32_t DiffServ::GetNTrafficClasses(void) const
   return m_classes.size();
 }
 
+void DiffServ::SetFlowCacheSize(uint32_t entries)
+{
+  NS_LOG_FUNCTION(this << entries);
+  m_flowCache.SetSize(entries);
+}
+
+uint32_t DiffServ::GetFlowCacheSize(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_flowCache.GetSize();
+}
+
+uint64_t DiffServ::GetFlowCacheHits(void) const
+{
+  return m_flowCache.GetHits();
+}
+
+uint64_t DiffServ::GetFlowCacheMisses(void) const
+{
+  return m_flowCache.GetMisses();
+}
+
+uint64_t DiffServ::GetFlowCacheEvictions(void) const
+{
+  return m_flowCache.GetEvictions();
+}
+
+void DiffServ::SetWakeCallback(WakeCallback cb)
+{
+  NS_LOG_FUNCTION(this);
+  m_wakeCallback = cb;
+}
+
+void DiffServ::SetReleaseGranularity(Time granularity)
+{
+  NS_LOG_FUNCTION(this << granularity);
+  m_releaseWheel.SetGranularity(granularity);
+}
+
+Time DiffServ::GetReleaseGranularity(void) const
+{
+  return m_releaseWheel.GetGranularity();
+}
+
+bool DiffServ::CanHoldPackets(void) const
+{
+  return !m_wakeCallback.IsNull();
+}
+
+void DiffServ::ScheduleWake(Time delay)
+{
+  NS_LOG_FUNCTION(this << delay);
+
+  if (m_wakeCallback.IsNull())
+  {
+    return;
+  }
+  Time at = Simulator::Now() + delay;
+  if (at >= m_wakeAt)
+  {
+    return;
+  }
+  m_wakeAt = at;
+  HoldUntil(WAKE_ENTRY, at);
+}
+
+bool DiffServ::CanServe(uint32_t classIndex)
+{
+  const Ptr<TrafficClass>& tClass = m_classes[classIndex];
+  if (tClass->IsEmpty())
+  {
+    return false;
+  }
+  if (!CanHoldPackets())
+  {
+    return true;
+  }
+  if (m_held[classIndex])
+  {
+    return false;
+  }
+  Time hold = tClass->GetHoldTime();
+  if (hold.IsZero())
+  {
+    return true;
+  }
+  NS_LOG_LOGIC("Traffic class " << classIndex << " held for " << hold);
+  m_held[classIndex] = true;
+  HoldUntil(classIndex, Simulator::Now() + hold);
+  return false;
+}
+
+void DiffServ::WakeForHeldClasses(void)
+{
+  // Schedulers may stop before asking every class; make sure that each
+  // held class is on the wheel so that the device is woken up for it
+  for (uint32_t i = 0; i < m_classes.size(); i++)
+  {
+    CanServe(i);
+  }
+}
+
+void DiffServ::HoldUntil(uint32_t id, Time when)
+{
+  m_releaseWheel.Insert(id, when);
+  ArmRelease();
+}
+
+void DiffServ::ArmRelease(void)
+{
+  Time next = m_releaseWheel.GetNextExpiry();
+  if (next == Time::Max())
+  {
+    return;
+  }
+  Time now = Simulator::Now();
+  if (next < now)
+  {
+    next = now;
+  }
+  if (m_wakeEvent.IsRunning() &&
+      static_cast<int64_t>(m_wakeEvent.GetTs()) <= next.GetTimeStep())
+  {
+    return;
+  }
+  m_wakeEvent.Cancel();
+  m_wakeEvent = Simulator::Schedule(next - now, &DiffServ::Release, this);
+}
+
+void DiffServ::Release(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  m_wakeEvent = EventId();
+  m_released.clear();
+  m_releaseWheel.Advance(Simulator::Now(), m_released);
+
+  bool wake = false;
+  for (uint32_t i = 0; i < m_released.size(); i++)
+  {
+    uint32_t id = m_released[i];
+    if (id == WAKE_ENTRY)
+    {
+      m_wakeAt = Time::Max();
+      wake = true;
+    }
+    else if (id < m_held.size() && m_held[id])
+    {
+      m_held[id] = false;
+      wake = true;
+    }
+  }
+  NS_LOG_LOGIC(m_released.size() << " wheel entries released");
+  ArmRelease();
+
+  if (wake && !IsEmpty())
+  {
+    m_wakeCallback();
+  }
+}
+
 bool DiffServ::Enqueue(Ptr<Packet> p)
 {
   NS_LOG_FUNCTION(this << p);
@@ -198,7 +724,21 @@ Ptr<Packet> DiffServ::Dequeue(void)
 Ptr<Packet> DiffServ::Remove(void)
 {
   NS_LOG_FUNCTION(this);
-  return Schedule();
+
+  if (IsEmpty())
+  {
+    NS_LOG_LOGIC("Queue empty");
+    return 0;
+  }
+
+  Ptr<Packet> p = GetScheduled();
+  if (p)
+  {
+    NS_LOG_LOGIC("Packet removed");
+    m_scheduled = 0;
+    Queue<Packet>::DoRemove(m_scheduledPosition);
+  }
+  return p;
 }
 
 Ptr<const Packet> DiffServ::Peek(void) const
@@ -207,4 +747,58 @@ Ptr<const Packet> DiffServ::Peek(void) const
   return DoPeek();
 }
 
+uint32_t DiffServ::EnqueueBurst(const std::vector<Ptr<Packet>>& packets)
+{
+  NS_LOG_FUNCTION(this << packets.size());
+
+  uint32_t enqueued = 0;
+  FlowKey lastKey = FlowKey();
+  uint32_t lastClass = 0;
+  for (uint32_t i = 0; i < packets.size(); i++)
+  {
+    FlowKey key = FlowKey::Parse(packets[i]);
+    if (i == 0 || !(key == lastKey))
+    {
+      lastKey = key;
+      lastClass = SelectClass(key);
+    }
+    if (EnqueueInClass(packets[i], key, lastClass))
+    {
+      enqueued++;
+    }
+  }
+
+  NS_LOG_LOGIC(enqueued << " of " << packets.size() << " packets enqueued");
+  return enqueued;
+}
+
+std::vector<Ptr<Packet>> DiffServ::DequeueBurst(uint32_t maxPackets,
+                                                uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION(this << maxPackets << maxBytes);
+
+  std::vector<Ptr<Packet>> packets;
+  uint32_t bytes = 0;
+  while (packets.size() < maxPackets && !IsEmpty())
+  {
+    Ptr<Packet> p = GetScheduled();
+    if (!p)
+    {
+      break;
+    }
+    if (maxBytes > 0 && !packets.empty() && bytes + p->GetSize() > maxBytes)
+    {
+      NS_LOG_LOGIC("Byte budget reached");
+      break;
+    }
+    m_scheduled = 0;
+    Queue<Packet>::DoDequeue(m_scheduledPosition);
+    bytes += p->GetSize();
+    packets.push_back(p);
+  }
+
+  NS_LOG_LOGIC(packets.size() << " packets (" << bytes << " bytes) dequeued");
+  return packets;
+}
+
 }
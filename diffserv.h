@@ -1,26 +1,84 @@
 #ifndef DIFFSERV_H
 #define DIFFSERV_H
 
+#include "flow-cache.h"
+#include "flow-key.h"
+#include "ns3/callback.h"
+#include "ns3/event-id.h"
 #include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/queue.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/traced-value.h"
+#include "timing-wheel.h"
 #include <vector>
 
 namespace ns3
 {
 
+class CompiledClassifier;
 class TrafficClass;
 
 /**
  * \ingroup queue
  * \brief A DiffServ queue
+ *
+ * Packets are stored in the traffic classes.  Every stored packet is also
+ * accounted in the Queue<Packet> base, so that MaxSize (in packets or
+ * bytes) bounds the buffer shared by all classes, and the QueueBase
+ * statistics and the Enqueue, Dequeue and Drop traces stay accurate; the
+ * class entry of the packet keeps its position in the base queue.  Each
+ * class can further bound its own share with MaxPackets and MaxBytes.
+ *
+ * With DynamicThresholds enabled, the shared buffer is also managed with
+ * Choudhury-Hahne dynamic thresholds: a class is admitted only while its
+ * occupancy stays within its Alpha times the free shared buffer, so that
+ * idle classes leave their memory to the busy ones while some headroom
+ * always remains for a class that becomes active.  Classes with UseEcn
+ * admit ECN-capable packets above their threshold, marked CE.
+ *
+ * When an arrival finds the shared buffer full, the OverflowPolicy decides
+ * whether it is refused (tail drop) or stored packets of another class
+ * make room for it: with pushout, the tail of the backlogged class with
+ * the lowest priority (highest PriorityLevel) below that of the arrival;
+ * with longest-queue-drop, the tail of the longest class, if longer than
+ * that of the arrival; with drop-from-front, the head of that same class.
+ * Pushed out and refused packets are reported through the Drop trace of
+ * their traffic class as well as the drop traces of the queue.
+ *
+ * Peek runs the scheduler and keeps the packet it selects, still
+ * accounted in the queue, for the next Dequeue or Remove; as with
+ * QueueDisc::Peek, a peeked packet is committed and later arrivals do not
+ * overtake it.  Peek and Dequeue therefore agree on the packet, whatever
+ * the scheduler, and a Peek followed by a Dequeue schedules once.
+ *
+ * EnqueueBurst and DequeueBurst handle a batch of packets per call with
+ * the same per-packet outcome as repeated Enqueue and Dequeue calls;
+ * consecutive packets of one flow are classified once.
+ *
+ * Schedulers that may hold back packets (rate ceilings, shapers) can only
+ * idle the link when a wake callback is installed, since the device does
+ * not poll the queue again by itself; they ask for a wake-up with
+ * ScheduleWake when the first held packet becomes eligible.  Held classes
+ * and wake-ups are kept in a TimingWheel rather than as one simulator
+ * event each: a single event is pending for the first occupied wheel
+ * slot, and when it fires every class due by then becomes eligible again
+ * and the device is woken once.  Release times are rounded up to the
+ * ReleaseGranularity.
  */
 class DiffServ : public Queue<Packet>
 {
 public:
+  /// What happens to an arrival that finds the shared buffer full
+  enum OverflowPolicy
+  {
+    OVERFLOW_TAIL_DROP,          //!< refuse the arrival
+    OVERFLOW_PUSHOUT,            //!< drop from the lowest priority class
+    OVERFLOW_LONGEST_QUEUE_DROP, //!< drop the tail of the longest class
+    OVERFLOW_DROP_FROM_FRONT,    //!< drop the head of the longest class
+  };
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -50,6 +108,13 @@ public:
    */
   virtual uint32_t Classify(Ptr<Packet> p);
 
+  /**
+   * \brief Classify an already parsed packet to the appropriate queue
+   * \param key The classification key parsed from the packet
+   * \return Queue index where the packet belongs
+   */
+  virtual uint32_t Classify(const FlowKey& key);
+
   /**
    * \brief Add a traffic class to this DiffServ queue
    * \param tClass The traffic class to add
@@ -67,12 +132,100 @@ public:
   virtual Ptr<Packet> Dequeue(void) override;
   virtual Ptr<Packet> Remove(void) override;
   virtual Ptr<const Packet> Peek(void) const override;
+
+  /**
+   * \brief Enqueue a batch of packets
+   *
+   * Each packet is admitted or dropped exactly as by Enqueue; a packet of
+   * the same flow as the one before it reuses its traffic class.
+   *
+   * \param packets The packets, in arrival order
+   * \return The number of packets enqueued
+   */
+  uint32_t EnqueueBurst(const std::vector<Ptr<Packet>>& packets);
+
+  /**
+   * \brief Dequeue a batch of packets
+   *
+   * Packets are taken in the order repeated Dequeue calls would return
+   * them.  A packet that would exceed maxBytes stays scheduled for the
+   * next call, unless it is the first one.
+   *
+   * \param maxPackets The largest number of packets to return
+   * \param maxBytes The largest total size to return; 0 for no limit
+   * \return The packets, fewer if the queue ran empty or the scheduler
+   *         holds the rest back
+   */
+  std::vector<Ptr<Packet>> DequeueBurst(uint32_t maxPackets,
+                                        uint32_t maxBytes);
   /**
    * \brief Get the number of traffic classes
    * \return The number of traffic classes
    */
   uint32_t GetNTrafficClasses(void) const;
 
+  /**
+   * \brief Classify with a rule set compiled elsewhere
+   *
+   * Queues built with identical traffic classes and filters can share one
+   * compiled classifier instead of compiling their own.  It is used until
+   * the rules of this queue change, after which the queue compiles its own
+   * again; changes to the rules of other queues leave it in place.
+   * Ignored if CompileRules is disabled.
+   *
+   * \param classifier The classifier, compiled from classes equivalent to
+   *        the ones of this queue; 0 if they cannot be compiled
+   */
+  void SetCompiledClassifier(Ptr<CompiledClassifier> classifier);
+
+  /**
+   * \brief Set the number of flows remembered by the flow cache
+   * \param entries The capacity; 0 disables the cache
+   */
+  void SetFlowCacheSize(uint32_t entries);
+
+  /**
+   * \brief Get the capacity of the flow cache
+   * \return The number of cache slots
+   */
+  uint32_t GetFlowCacheSize(void) const;
+
+  /**
+   * \return The number of packets classified from the flow cache
+   */
+  uint64_t GetFlowCacheHits(void) const;
+
+  /**
+   * \return The number of packets that missed the flow cache
+   */
+  uint64_t GetFlowCacheMisses(void) const;
+
+  /**
+   * \return The number of flows evicted from the flow cache
+   */
+  uint64_t GetFlowCacheEvictions(void) const;
+
+  /// Callback restarting transmission when held packets become eligible
+  typedef Callback<void> WakeCallback;
+
+  /**
+   * \brief Set the callback that restarts the device when packets held
+   *        back by the scheduler become eligible
+   * \param cb The callback; a null callback keeps the queue work-conserving
+   */
+  void SetWakeCallback(WakeCallback cb);
+
+  /**
+   * \brief Set the tick of the wheel releasing held packets
+   * \param granularity The tick; no packet may be held when it changes
+   */
+  void SetReleaseGranularity(Time granularity);
+
+  /**
+   * \return The tick of the wheel releasing held packets
+   */
+  Time GetReleaseGranularity(void) const;
+
 protected:
   /**
    * \brief Dispose of the object
@@ -103,7 +256,200 @@ protected:
    */
   virtual bool IsEmpty(void) const;
 
+  /**
+   * \brief Notify the scheduler that a packet entered a traffic class
+   *
+   * Called after the packet has been stored, so that schedulers can keep
+   * their own bookkeeping of backlogged classes instead of scanning.
+   *
+   * \param classIndex The index of the traffic class
+   * \param p The enqueued packet
+   */
+  virtual void NotifyEnqueue(uint32_t classIndex, Ptr<const Packet> p);
+
+  /**
+   * \brief Get the compiled form of the current rule set
+   *
+   * Recompiles if traffic classes, filters or filter elements changed
+   * since the last call.
+   *
+   * \return The compiled classifier, or 0 if compilation is disabled or
+   *         the rule set contains elements that cannot be compiled
+   */
+  Ptr<CompiledClassifier> GetCompiledClassifier(void);
+
+  /**
+   * \brief Get the generation of the scheduling parameters
+   *
+   * Moves whenever a traffic class is added or the priority level or
+   * weight of one changes, so that schedulers keeping state derived from
+   * them know when to rebuild it.
+   *
+   * \return The generation counter
+   */
+  uint64_t GetSchedulingGeneration(void) const;
+
+  /**
+   * \brief Check whether the scheduler may leave backlogged packets waiting
+   * \return True if a wake callback is installed
+   */
+  bool CanHoldPackets(void) const;
+
+  /**
+   * \brief Invoke the wake callback after a delay
+   *
+   * Only the earliest pending wake-up is kept.
+   *
+   * \param delay The time until held packets become eligible
+   */
+  void ScheduleWake(Time delay);
+
+  /**
+   * \brief Check whether a traffic class may be served now
+   *
+   * A class whose shaper holds its head packet is skipped, unless no wake
+   * callback is installed, in which case shaping gives way to keeping the
+   * link busy.  A held class is put on the release wheel and not asked
+   * again until its release time has passed.
+   *
+   * \param classIndex The index of the traffic class
+   * \return True if the class has a packet that may leave now
+   */
+  bool CanServe(uint32_t classIndex);
+
   std::vector<Ptr<TrafficClass>> m_classes;
+
+private:
+  /**
+   * \brief Recompile the rule set if it changed since the last compilation
+   */
+  void RefreshCompiledClassifier(void);
+
+  /**
+   * \brief Get the version of the rules of this queue
+   * \return The sum of the rule versions of the traffic classes
+   */
+  uint64_t GetRulesVersion(void) const;
+
+  /**
+   * \brief Get the packet the next Dequeue returns, running the scheduler
+   *        if no decision is pending
+   * \return The packet, or 0 if nothing may be sent now
+   */
+  Ptr<Packet> GetScheduled(void);
+
+  /**
+   * \brief Select the traffic class of a parsed packet
+   * \param key The classification key parsed from the packet
+   * \return The index of a traffic class, 0 if none matches
+   */
+  uint32_t SelectClass(const FlowKey& key);
+
+  /**
+   * \brief Admit a classified packet to its traffic class
+   * \param p The packet
+   * \param key The classification key parsed from the packet
+   * \param classIndex The traffic class selected for the packet
+   * \return True if the packet was enqueued
+   */
+  bool EnqueueInClass(Ptr<Packet> p, const FlowKey& key, uint32_t classIndex);
+
+  /**
+   * \brief Push out stored packets until an arrival fits the shared buffer
+   * \param classIndex The traffic class selected for the arrival
+   * \param p The arriving packet
+   * \return True if the packet now fits; packets already pushed out stay
+   *         dropped otherwise
+   */
+  bool MakeRoom(uint32_t classIndex, Ptr<const Packet> p);
+
+  /**
+   * \brief Select the traffic class giving up a packet for an arrival
+   * \param classIndex The traffic class selected for the arrival
+   * \param p The arriving packet
+   * \return The class index, or GetNTrafficClasses() if the policy lets
+   *         no class give way
+   */
+  uint32_t SelectVictim(uint32_t classIndex, Ptr<const Packet> p) const;
+
+  /**
+   * \brief Get the share of the buffer held by a class, in MaxSize units
+   * \param classIndex The index of the traffic class
+   * \return The number of packets or bytes stored in the class
+   */
+  uint32_t GetOccupancy(uint32_t classIndex) const;
+
+  /**
+   * \brief Record that a scheduling parameter of a traffic class changed
+   */
+  void NotifySchedulingChanged(void);
+
+  /**
+   * \brief Account a packet dropped by a traffic class after it was stored
+   * \param p The packet
+   * \param position The base queue entry of the packet
+   */
+  void DropFromClass(Ptr<Packet> p, ConstIterator position);
+
+  /**
+   * \brief Record the base queue entry of a packet a class dequeued
+   * \param position The base queue entry
+   */
+  void NotifyDeparture(ConstIterator position);
+
+  /// Release wheel identifier of the wake-ups asked for by ScheduleWake
+  static const uint32_t WAKE_ENTRY = 0xffffffff;
+
+  /**
+   * \brief Put an entry on the release wheel
+   * \param id The class index, or WAKE_ENTRY
+   * \param when The release time
+   */
+  void HoldUntil(uint32_t id, Time when);
+
+  /**
+   * \brief Keep the release event at the next expiry of the wheel
+   */
+  void ArmRelease(void);
+
+  /**
+   * \brief Advance the release wheel and run the wake callback once if
+   *        any held class became eligible
+   */
+  void Release(void);
+
+  /**
+   * \brief Put the backlogged classes held by their shaper on the wheel
+   */
+  void WakeForHeldClasses(void);
+
+  /**
+   * \brief Check a packet against the dynamic threshold of its class
+   * \param tClass The traffic class selected for the packet
+   * \param p The packet
+   * \return True if the class stays within its threshold with the packet
+   */
+  bool IsWithinDynamicThreshold(const Ptr<TrafficClass>& tClass,
+                                Ptr<const Packet> p) const;
+
+  bool m_dynamicThresholds;              //!< share the buffer by alpha
+  OverflowPolicy m_overflowPolicy;       //!< fate of arrivals when full
+  bool m_compileRules;                   //!< use the compiled classifier
+  Ptr<CompiledClassifier> m_compiled;    //!< compiled rule set
+  uint64_t m_compiledGeneration;         //!< global rule generation checked
+  uint64_t m_compiledVersion;            //!< own rule version of m_compiled
+  uint32_t m_compiledClasses;            //!< class count of m_compiled
+  uint64_t m_schedulingGeneration;       //!< scheduling parameter changes
+  FlowCache m_flowCache;                 //!< flow to class index cache
+  WakeCallback m_wakeCallback;           //!< restarts the device
+  TimingWheel m_releaseWheel;            //!< held classes and wake-ups
+  std::vector<bool> m_held;              //!< class is on the release wheel
+  std::vector<uint32_t> m_released;      //!< entries released by the wheel
+  Time m_wakeAt;                         //!< earliest ScheduleWake pending
+  EventId m_wakeEvent;                   //!< pending wheel release
+  Ptr<Packet> m_scheduled;               //!< peeked, next to be dequeued
+  ConstIterator m_scheduledPosition;     //!< base queue entry of m_scheduled
+  ConstIterator m_departed;              //!< entry of the last class dequeue
 };
 
 }
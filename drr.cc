@@ -1,8 +1,10 @@
 #include "drr.h"
+#include "class-aqm.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "traffic-class.h"
 #include <fstream>
+#include <sstream>
 
 namespace ns3
 {
@@ -20,7 +22,7 @@ TypeId DRR::GetTypeId(void)
 }
 
 DRR::DRR()
-    : m_lastQueueServed(0)
+    : m_activeList(), m_isActive(), m_headCredited(false)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -35,6 +37,8 @@ void DRR::DoDispose(void)
   NS_LOG_FUNCTION(this);
   m_deficits.clear();
   m_quantums.clear();
+  m_activeList.clear();
+  m_isActive.clear();
   DiffServ::DoDispose();
 }
 
@@ -88,10 +92,17 @@ bool DRR::SetConfigFile(std::string filename)
   m_deficits.resize(numQueuesFromFile);
 
   NS_LOG_INFO("DRR: Configuring " << numQueuesFromFile << " queues.");
+  // One queue per line: quantum, optionally followed by an AQM name
+  std::string line;
   for (uint32_t i = 0; i < numQueuesFromFile; ++i)
   {
-    configFileStream >> m_quantums[i];
-    if (configFileStream.fail() ||
+    while (std::getline(configFileStream, line) &&
+           line.find_first_not_of(" \t\r") == std::string::npos)
+    {
+    }
+    std::istringstream lineStream(line);
+    lineStream >> m_quantums[i];
+    if (configFileStream.fail() || lineStream.fail() ||
         m_quantums[i] == 0)
     {
       NS_LOG_ERROR("DRR: Invalid quantum for queue "
@@ -99,118 +110,171 @@ bool DRR::SetConfigFile(std::string filename)
       configFileStream.close();
       return false;
     }
+    std::string aqmName;
+    if (lineStream >> aqmName)
+    {
+      Ptr<ClassAqm> aqm;
+      if (!ClassAqm::CreateFromName(aqmName, aqm))
+      {
+        NS_LOG_ERROR("DRR: Invalid AQM " << aqmName << " for queue " << i
+                                         << " in DRR config file: "
+                                         << filename);
+        configFileStream.close();
+        return false;
+      }
+      GetTrafficClass(i)->SetAqm(aqm);
+    }
     m_deficits[i] = 0;
     NS_LOG_INFO("DRR: Queue " << i << " - Quantum: " << m_quantums[i]
                               << ", Initial Deficit: " << m_deficits[i]);
   }
   configFileStream.close();
 
-  m_lastQueueServed = (numQueuesFromFile > 0) ? (numQueuesFromFile - 1) : 0;
+  ResetActiveList();
 
   NS_LOG_INFO("DRR: Configuration loaded successfully from " << filename);
   return true;
 }
 
-Ptr<Packet> DRR::Schedule(void)
+void DRR::SetQuantum(uint32_t classIndex, uint32_t quantum)
+{
+  NS_LOG_FUNCTION(this << classIndex << quantum);
+  NS_ASSERT(classIndex < GetNTrafficClasses());
+  if (classIndex >= m_quantums.size())
+  {
+    m_quantums.resize(classIndex + 1, 0);
+    m_deficits.resize(classIndex + 1, 0);
+  }
+  m_quantums[classIndex] = quantum;
+  m_deficits[classIndex] = 0;
+  ResetActiveList();
+}
+
+uint32_t DRR::GetQuantum(uint32_t classIndex) const
+{
+  return (classIndex < m_quantums.size()) ? m_quantums[classIndex] : 0;
+}
+
+void DRR::ResetActiveList(void)
 {
   NS_LOG_FUNCTION(this);
-  uint32_t numManagedQueues = m_quantums.size();
+  m_activeList.clear();
+  m_isActive.assign(m_quantums.size(), false);
+  m_headCredited = false;
+
+  for (uint32_t i = 0; i < m_quantums.size() && i < GetNTrafficClasses(); ++i)
+  {
+    if (m_quantums[i] != 0 && !m_classes[i]->IsEmpty())
+    {
+      m_activeList.push_back(i);
+      m_isActive[i] = true;
+    }
+  }
+}
 
-  if (numManagedQueues == 0)
+void DRR::NotifyEnqueue(uint32_t classIndex, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << classIndex << p);
+
+  if (classIndex >= m_quantums.size() || m_quantums[classIndex] == 0)
   {
-    NS_LOG_LOGIC("DRR: No queues managed. Nothing to schedule.");
-    return nullptr;
+    NS_LOG_WARN("DRR: Traffic class " << classIndex
+                                      << " has no quantum configured.");
+    return;
   }
-  if (GetNTrafficClasses() < numManagedQueues)
+  if (!m_isActive[classIndex])
   {
-    NS_LOG_WARN("DRR: Mismatch between configured queues ("
-                << numManagedQueues
-                << ") and available TrafficClasses in base DiffServ ("
-                << GetNTrafficClasses() << "). Cannot schedule.");
-    return nullptr;
+    NS_LOG_LOGIC("DRR: Queue " << classIndex << " joins the active list.");
+    m_activeList.push_back(classIndex);
+    m_isActive[classIndex] = true;
   }
+}
 
-  for (uint32_t i = 0; i < numManagedQueues; ++i)
+Ptr<Packet> DRR::Schedule(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  // Classes held by their shaper consecutively; once all active classes
+  // are held, nothing can be sent
+  uint32_t nHeld = 0;
+  while (!m_activeList.empty())
   {
-    uint32_t currentQueueIndex = (m_lastQueueServed + 1 + i) % numManagedQueues;
+    uint32_t queueIndex = m_activeList.front();
+    const Ptr<TrafficClass>& tc = m_classes[queueIndex];
 
-    Ptr<TrafficClass> tc = GetTrafficClass(currentQueueIndex);
-    if (!tc)
+    if (tc->IsEmpty())
     {
-      NS_LOG_WARN("DRR: TrafficClass for queue "
-                  << currentQueueIndex << " is unexpectedly null. Skipping.");
+      // Drained behind our back (e.g. the class was flushed)
+      m_activeList.pop_front();
+      m_isActive[queueIndex] = false;
+      m_deficits[queueIndex] = 0;
+      m_headCredited = false;
       continue;
     }
 
-    if (tc->IsEmpty())
+    if (!CanServe(queueIndex))
     {
-      NS_LOG_LOGIC("DRR: Queue " << currentQueueIndex
-                                 << " is empty. Skipping.");
+      NS_LOG_DEBUG("DRR: Queue " << queueIndex << " held by its shaper.");
+      m_activeList.pop_front();
+      m_activeList.push_back(queueIndex);
+      m_headCredited = false;
+      if (++nHeld >= m_activeList.size())
+      {
+        return 0;
+      }
       continue;
     }
+    nHeld = 0;
 
-    m_deficits[currentQueueIndex] += m_quantums[currentQueueIndex];
-    NS_LOG_DEBUG(
-        "DRR: Queue "
-        << currentQueueIndex << " gets turn. Prior Deficit: "
-        << (m_deficits[currentQueueIndex] -
-            m_quantums[currentQueueIndex])
-        << ", Quantum: " << m_quantums[currentQueueIndex]
-        << ". Total Deficit for round: " << m_deficits[currentQueueIndex]);
-
-    if (!tc->IsEmpty() && m_deficits[currentQueueIndex] > 0)
+    if (!m_headCredited)
     {
-      Ptr<Packet> packetToPeek = tc->Peek();
-      NS_ASSERT(packetToPeek);
-      uint32_t packetSize = packetToPeek->GetSize();
-
-      NS_LOG_DEBUG("DRR: Queue "
-                   << currentQueueIndex << " Peeked packet size: " << packetSize
-                   << "B. Deficit: " << m_deficits[currentQueueIndex]);
+      m_deficits[queueIndex] += m_quantums[queueIndex];
+      m_headCredited = true;
+      NS_LOG_DEBUG("DRR: Queue " << queueIndex << " gets turn. Quantum: "
+                                 << m_quantums[queueIndex]
+                                 << ". Total Deficit for round: "
+                                 << m_deficits[queueIndex]);
+    }
 
-      if (packetSize <= m_deficits[currentQueueIndex])
+    uint32_t packetSize = tc->Peek()->GetSize();
+    if (packetSize <= m_deficits[queueIndex])
+    {
+      // The AQM may drop the head and send a larger packet instead: charge
+      // what is sent in full, the overdraft is repaid in the next rounds
+      Ptr<Packet> packetToSend = tc->Dequeue();
+      if (!packetToSend)
       {
-        Ptr<Packet> packetToSend = tc->Dequeue();
-        m_deficits[currentQueueIndex] -= packetSize;
-
-        NS_LOG_INFO("DRR: Dequeued packet (size "
-                    << packetSize << "B) from queue " << currentQueueIndex
-                    << ". Deficit remaining: "
-                    << m_deficits[currentQueueIndex]);
-
-        m_lastQueueServed = currentQueueIndex;
-
-        if (tc->IsEmpty())
-        {
-          NS_LOG_DEBUG("DRR: Queue "
-                       << currentQueueIndex
-                       << " is now empty. Resetting deficit to 0.");
-          m_deficits[currentQueueIndex] = 0;
-        }
-        return packetToSend;
+        continue;
       }
-      else
-      {
+      packetSize = packetToSend->GetSize();
+      m_deficits[queueIndex] -= packetSize;
 
-        NS_LOG_DEBUG(
-            "DRR: Queue "
-            << currentQueueIndex << " head packet (size " << packetSize
-            << "B) > deficit (" << m_deficits[currentQueueIndex]
-            << "). No packet sent from this queue. Deficit carried over.");
+      NS_LOG_INFO("DRR: Dequeued packet (size "
+                  << packetSize << "B) from queue " << queueIndex
+                  << ". Deficit remaining: " << m_deficits[queueIndex]);
+
+      if (tc->IsEmpty())
+      {
+        NS_LOG_DEBUG("DRR: Queue " << queueIndex
+                                   << " is now empty. Resetting deficit to 0.");
+        m_activeList.pop_front();
+        m_isActive[queueIndex] = false;
+        m_deficits[queueIndex] = 0;
+        m_headCredited = false;
       }
+      return packetToSend;
     }
-    else
-    {
-      NS_LOG_DEBUG(
-          "DRR: Queue "
-          << currentQueueIndex
-          << " could not send (e.g. became empty or non-positive deficit "
-          << m_deficits[currentQueueIndex] << " before sending).");
-    }
+
+    NS_LOG_DEBUG("DRR: Queue " << queueIndex << " head packet (size "
+                               << packetSize << "B) > deficit ("
+                               << m_deficits[queueIndex]
+                               << "). Deficit carried over to next round.");
+    m_activeList.pop_front();
+    m_activeList.push_back(queueIndex);
+    m_headCredited = false;
   }
 
-  NS_LOG_LOGIC("DRR: No packet could be scheduled in this full scan of "
-               << numManagedQueues << " queues.");
+  NS_LOG_LOGIC("DRR: No backlogged queue to schedule.");
   return nullptr;
 }
 
@@ -2,12 +2,23 @@
 #define DRR_H
 
 #include "diffserv.h"
+#include <deque>
 #include <string>
 #include <vector>
 
 namespace ns3
 {
 
+/**
+ * \ingroup queue
+ * \brief Deficit Round Robin in the Shreedhar-Varghese active-list form
+ *
+ * Only backlogged classes are kept in a FIFO.  The class at the head gets
+ * its quantum once per visit and is served while its deficit covers the
+ * head packet, then moves to the tail; a class leaving the list because it
+ * drained forfeits its deficit.  Dequeue cost does not depend on the number
+ * of configured classes.
+ */
 class DRR : public DiffServ
 {
 public:
@@ -23,14 +34,45 @@ public:
    */
   bool SetConfigFile(std::string filename);
 
+  /**
+   * \brief Set the quantum of a traffic class
+   *
+   * Classes without a quantum, or with a quantum of 0, are not served.
+   *
+   * \param classIndex The index of the traffic class
+   * \param quantum The bytes credited to the class per round
+   */
+  void SetQuantum(uint32_t classIndex, uint32_t quantum);
+
+  /**
+   * \param classIndex The index of the traffic class
+   * \return The quantum of the class, 0 if none
+   */
+  uint32_t GetQuantum(uint32_t classIndex) const;
+
 protected:
   virtual void DoDispose(void) override;
 
+  /**
+   * \brief Append a class that became backlogged to the active list
+   * \param classIndex The index of the traffic class
+   * \param p The enqueued packet
+   */
+  virtual void NotifyEnqueue(uint32_t classIndex,
+                             Ptr<const Packet> p) override;
+
 private:
-  std::vector<uint32_t>
-      m_deficits;
+  /**
+   * \brief Rebuild the active list from the current class backlogs
+   */
+  void ResetActiveList(void);
+
+  std::vector<int64_t>
+      m_deficits; //!< negative after an AQM drop let a larger packet out
   std::vector<uint32_t> m_quantums;
-  uint32_t m_lastQueueServed;
+  std::deque<uint32_t> m_activeList; //!< backlogged classes, head is served
+  std::vector<bool> m_isActive;      //!< class is in the active list
+  bool m_headCredited;               //!< head got its quantum for this visit
   std::string m_configFile;
 };
 }
@@ -0,0 +1,89 @@
+#include "dscp-filter.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("DscpFilter");
+NS_OBJECT_ENSURE_REGISTERED(DscpFilter);
+
+TypeId DscpFilter::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::DscpFilter")
+                          .SetParent<FilterElement>()
+                          .SetGroupName("Network")
+                          .AddConstructor<DscpFilter>();
+  return tid;
+}
+
+DscpFilter::DscpFilter() : m_dscps(0)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+DscpFilter::DscpFilter(uint8_t dscp) : m_dscps(0)
+{
+  NS_LOG_FUNCTION(this << static_cast<uint32_t>(dscp));
+  AddDscp(dscp);
+}
+
+DscpFilter::~DscpFilter()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void DscpFilter::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  FilterElement::DoDispose();
+}
+
+bool DscpFilter::Match(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (key.flags & FlowKey::IPV4)
+  {
+    return (m_dscps >> key.dscp) & 1;
+  }
+
+  NS_LOG_LOGIC("Packet doesn't have an IPv4 header");
+  return false;
+}
+
+bool DscpFilter::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  for (uint8_t dscp = 0; dscp < 64; dscp++)
+  {
+    if ((m_dscps >> dscp) & 1)
+    {
+      FlowPattern pattern = FlowPattern::Any();
+      pattern.value.dscp = dscp;
+      pattern.mask.dscp = 0x3f;
+      pattern.value.flags = FlowKey::IPV4;
+      pattern.mask.flags = FlowKey::IPV4;
+      patterns.push_back(pattern);
+    }
+  }
+  return true;
+}
+
+void DscpFilter::AddDscp(uint8_t dscp)
+{
+  NS_LOG_FUNCTION(this << static_cast<uint32_t>(dscp));
+  NS_ASSERT_MSG(dscp < 64, "DSCP codepoint out of range: "
+                                   << static_cast<uint32_t>(dscp));
+  m_dscps |= static_cast<uint64_t>(1) << dscp;
+  NotifyRulesChanged();
+}
+
+uint64_t DscpFilter::GetDscpMask(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_dscps;
+}
+
+}
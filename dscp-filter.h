@@ -0,0 +1,77 @@
+#ifndef DSCP_FILTER_H
+#define DSCP_FILTER_H
+
+#include "filter-element.h"
+
+namespace ns3
+{
+
+/**
+ * \brief Filter element for the DSCP codepoint of the IPv4 TOS field
+ *
+ * Holds a set of codepoints as a 64-bit mask, so one element can stand
+ * for a whole DSCP-to-queue mapping.
+ */
+class DscpFilter : public FilterElement
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Default constructor, matches no codepoint
+   */
+  DscpFilter();
+
+  /**
+   * \brief Constructor with a single codepoint
+   * \param dscp The DSCP codepoint to match, 0 to 63
+   */
+  DscpFilter(uint8_t dscp);
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~DscpFilter();
+
+  /**
+   * \brief Check if a packet matches this filter element
+   * \param key The classification key parsed from the packet
+   * \return True if the packet's DSCP is one of the configured codepoints
+   */
+  virtual bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe this element as exact matches on the DSCP
+   * \param patterns Output: one pattern per codepoint
+   * \return Always true
+   */
+  virtual bool GetPatterns(std::vector<FlowPattern>& patterns) const;
+
+  /**
+   * \brief Add a codepoint to match
+   * \param dscp The DSCP codepoint, 0 to 63
+   */
+  void AddDscp(uint8_t dscp);
+
+  /**
+   * \brief Get the configured codepoints
+   * \return A mask where bit N is set iff codepoint N matches
+   */
+  uint64_t GetDscpMask(void) const;
+
+private:
+  uint64_t m_dscps; //!< The codepoints to match, one bit each
+
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose(void);
+};
+
+}
+
+#endif
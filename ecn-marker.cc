@@ -0,0 +1,99 @@
+#include "ecn-marker.h"
+#include "ns3/assert.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/log.h"
+#include "ns3/ppp-header.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EcnMarker");
+
+bool EcnMarker::ReadTos(Ptr<const Packet> p, uint8_t& tos, bool& checksum)
+{
+  // PPP protocol field and the IPv4 header up to the checksum
+  uint8_t buf[2 + 12];
+  uint32_t len = p->CopyData(buf, sizeof(buf));
+  bool hasPpp = len >= 2 && buf[0] == 0x00 && buf[1] == 0x21;
+  const uint8_t* ip = hasPpp ? buf + 2 : buf;
+  if (len < (hasPpp ? 2u : 0u) + 12 || (ip[0] >> 4) != 4)
+  {
+    NS_LOG_LOGIC("No IPv4 header found");
+    return false;
+  }
+  tos = ip[1];
+  checksum = ip[10] != 0 || ip[11] != 0;
+  return true;
+}
+
+void EcnMarker::Rewrite(Ptr<Packet> p, uint8_t tos, bool checksum)
+{
+  PppHeader ppp;
+  uint8_t buf[2];
+  bool hasPpp = p->CopyData(buf, sizeof(buf)) == 2 && buf[0] == 0x00 &&
+                buf[1] == 0x21;
+  if (hasPpp)
+  {
+    p->RemoveHeader(ppp);
+  }
+  Ipv4Header header;
+  p->RemoveHeader(header);
+  header.SetTos(tos);
+  if (checksum)
+  {
+    header.EnableChecksum();
+  }
+  p->AddHeader(header);
+  if (hasPpp)
+  {
+    p->AddHeader(ppp);
+  }
+}
+
+bool EcnMarker::MarkCe(Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION(p);
+
+  uint8_t tos;
+  bool checksum;
+  if (!ReadTos(p, tos, checksum))
+  {
+    return false;
+  }
+
+  uint8_t ecn = tos & 0x03;
+  if (ecn == Ipv4Header::ECN_NotECT)
+  {
+    NS_LOG_LOGIC("Packet is not ECN-capable");
+    return false;
+  }
+  if (ecn == Ipv4Header::ECN_CE)
+  {
+    return true;
+  }
+
+  Rewrite(p, tos | Ipv4Header::ECN_CE, checksum);
+  NS_LOG_LOGIC("Marked CE");
+  return true;
+}
+
+bool EcnMarker::SetDscp(Ptr<Packet> p, uint8_t dscp)
+{
+  NS_LOG_FUNCTION(p << static_cast<uint32_t>(dscp));
+  NS_ASSERT(dscp < 64);
+
+  uint8_t tos;
+  bool checksum;
+  if (!ReadTos(p, tos, checksum))
+  {
+    return false;
+  }
+  if ((tos >> 2) != dscp)
+  {
+    Rewrite(p, static_cast<uint8_t>(dscp << 2) | (tos & 0x03), checksum);
+    NS_LOG_LOGIC("Re-marked DSCP " << static_cast<uint32_t>(dscp));
+  }
+  return true;
+}
+
+}
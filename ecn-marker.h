@@ -0,0 +1,59 @@
+#ifndef ECN_MARKER_H
+#define ECN_MARKER_H
+
+#include "ns3/packet.h"
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Rewrites the IPv4 ECN and DSCP fields of a queued packet
+ *
+ * Like FlowKey::Parse, accepts packets starting either with the IPv4
+ * header or with the PPP header that PointToPointNetDevice prepends.
+ * The headers are removed and added back with the new codepoint; the
+ * IPv4 checksum is recomputed if the packet carried one.
+ */
+class EcnMarker
+{
+public:
+  /**
+   * \brief Set the ECN field of an ECN-capable packet to CE
+   * \param p The packet, modified in place
+   * \return True if the packet is ECN-capable (ECT(0), ECT(1) or already
+   *         CE) and is now marked CE; false if it is not ECN-capable
+   */
+  static bool MarkCe(Ptr<Packet> p);
+
+  /**
+   * \brief Re-mark the DSCP of an IPv4 packet
+   * \param p The packet, modified in place
+   * \param dscp The new codepoint, below 64
+   * \return True if the packet is IPv4 and now carries the codepoint
+   */
+  static bool SetDscp(Ptr<Packet> p, uint8_t dscp);
+
+private:
+  /**
+   * \brief Rewrite the type of service byte of an IPv4 packet
+   * \param p The packet, modified in place
+   * \param tos The new type of service byte
+   * \param checksum True to recompute the header checksum
+   */
+  static void Rewrite(Ptr<Packet> p, uint8_t tos, bool checksum);
+
+  /**
+   * \brief Read the start of the IPv4 header
+   * \param p The packet
+   * \param tos Output: the type of service byte
+   * \param checksum Output: true if the header carries a checksum
+   * \return True if the packet is IPv4
+   */
+  static bool ReadTos(Ptr<const Packet> p, uint8_t& tos, bool& checksum);
+};
+
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "filter-element.h"
+#include "compiled-classifier.h"
 #include "ns3/log.h"
 
 namespace ns3
@@ -14,7 +15,7 @@ TypeId FilterElement::GetTypeId(void)
   return tid;
 }
 
-FilterElement::FilterElement()
+FilterElement::FilterElement() : m_rulesVersion(0)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -24,6 +25,23 @@ FilterElement::~FilterElement()
   NS_LOG_FUNCTION(this);
 }
 
+bool FilterElement::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+  return false;
+}
+
+uint64_t FilterElement::GetRulesVersion(void) const
+{
+  return m_rulesVersion;
+}
+
+void FilterElement::NotifyRulesChanged(void)
+{
+  m_rulesVersion++;
+  CompiledClassifier::NotifyRulesChanged();
+}
+
 void FilterElement::DoDispose(void)
 {
   NS_LOG_FUNCTION(this);
@@ -1,8 +1,9 @@
 #ifndef FILTER_ELEMENT_H
 #define FILTER_ELEMENT_H
 
+#include "flow-key.h"
 #include "ns3/object.h"
-#include "ns3/packet.h"
+#include <vector>
 
 namespace ns3
 {
@@ -31,17 +32,44 @@ public:
   virtual ~FilterElement();
 
   /**
-   * \brief Check if packet matches this filter element
-   * \param p The packet to check
+   * \brief Check if a packet matches this filter element
+   * \param key The classification key parsed from the packet
    * \return True if the packet matches, false otherwise
    */
-  virtual bool Match(Ptr<Packet> p) = 0;
+  virtual bool Match(const FlowKey& key) const = 0;
+
+  /**
+   * \brief Describe this element as a set of masked key patterns
+   *
+   * A packet matches the element iff its key matches at least one of the
+   * patterns.  Elements that can be described this way are indexed by the
+   * CompiledClassifier; the default implementation reports that the
+   * element can only be evaluated through Match().
+   *
+   * \param patterns Output: the patterns, appended to the vector
+   * \return False if the element cannot be expressed as patterns
+   */
+  virtual bool GetPatterns(std::vector<FlowPattern>& patterns) const;
+
+  /**
+   * \brief Get the version of the packets this element matches
+   * \return A counter moving whenever the element is changed
+   */
+  uint64_t GetRulesVersion(void) const;
 
 protected:
   /**
    * \brief Dispose of the object
    */
   virtual void DoDispose(void);
+
+  /**
+   * \brief Record that the packets this element matches changed
+   */
+  void NotifyRulesChanged(void);
+
+private:
+  uint64_t m_rulesVersion; //!< changes to the matched packets
 };
 
 }
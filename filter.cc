@@ -1,4 +1,5 @@
 #include "filter.h"
+#include "compiled-classifier.h"
 #include "filter-element.h"
 #include "ns3/log.h"
 
@@ -17,7 +18,7 @@ TypeId Filter::GetTypeId(void)
   return tid;
 }
 
-Filter::Filter() : m_elements()
+Filter::Filter() : m_elements(), m_rulesVersion(0)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -40,11 +41,25 @@ void Filter::AddFilterElement(Ptr<FilterElement> element)
 {
   NS_LOG_FUNCTION(this << element);
   m_elements.push_back(element);
+  m_rulesVersion++;
+  CompiledClassifier::NotifyRulesChanged();
 }
 
-bool Filter::Match(Ptr<Packet> p)
+uint64_t Filter::GetRulesVersion(void) const
 {
-  NS_LOG_FUNCTION(this << p);
+  // Versions only grow and elements are never removed, so the sum moves
+  // whenever one of them does
+  uint64_t version = m_rulesVersion;
+  for (uint32_t i = 0; i < m_elements.size(); i++)
+  {
+    version += m_elements[i]->GetRulesVersion();
+  }
+  return version;
+}
+
+bool Filter::Match(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
 
   if (m_elements.empty())
   {
@@ -54,7 +69,7 @@ bool Filter::Match(Ptr<Packet> p)
 
   for (uint32_t i = 0; i < m_elements.size(); i++)
   {
-    if (!m_elements[i]->Match(p))
+    if (!m_elements[i]->Match(key))
     {
       NS_LOG_LOGIC("Packet doesn't match filter element " << i);
       return false;
@@ -65,4 +80,45 @@ bool Filter::Match(Ptr<Packet> p)
   return true;
 }
 
+bool Filter::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  std::vector<FlowPattern> product(1, FlowPattern::Any());
+
+  for (uint32_t i = 0; i < m_elements.size(); i++)
+  {
+    std::vector<FlowPattern> alternatives;
+    if (!m_elements[i]->GetPatterns(alternatives))
+    {
+      NS_LOG_LOGIC("Filter element " << i << " cannot be compiled");
+      return false;
+    }
+
+    std::vector<FlowPattern> next;
+    for (uint32_t j = 0; j < product.size(); j++)
+    {
+      for (uint32_t k = 0; k < alternatives.size(); k++)
+      {
+        FlowPattern combined;
+        if (product[j].Intersect(alternatives[k], combined))
+        {
+          next.push_back(combined);
+        }
+      }
+    }
+
+    if (next.size() > MAX_PATTERNS)
+    {
+      NS_LOG_LOGIC("Filter expands to more than " << MAX_PATTERNS
+                                                  << " patterns");
+      return false;
+    }
+    product.swap(next);
+  }
+
+  patterns.insert(patterns.end(), product.begin(), product.end());
+  return true;
+}
+
 }
@@ -1,8 +1,8 @@
 #ifndef FILTER_H
 #define FILTER_H
 
+#include "flow-key.h"
 #include "ns3/object.h"
-#include "ns3/packet.h"
 #include <vector>
 
 namespace ns3
@@ -34,10 +34,25 @@ public:
 
   /**
    * \brief Check if a packet matches this filter
-   * \param p The packet to check
-   * \return True if the packet matches this filter
+   * \param key The classification key parsed from the packet
+   * \return True if the packet matches all filter elements
    */
-  bool Match(Ptr<Packet> p);
+  bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe this filter as a set of masked key patterns
+   *
+   * The patterns of the individual elements are intersected, so a key
+   * matches the filter iff it matches at least one resulting pattern.
+   *
+   * \param patterns Output: the patterns, appended to the vector
+   * \return False if an element cannot be expressed as patterns or the
+   *         expansion exceeds MAX_PATTERNS
+   */
+  bool GetPatterns(std::vector<FlowPattern>& patterns) const;
+
+  /// Upper bound on the number of patterns a single filter may expand to
+  static const uint32_t MAX_PATTERNS = 4096;
 
   /**
    * \brief Add a filter element to this filter
@@ -45,6 +60,12 @@ public:
    */
   void AddFilterElement(Ptr<FilterElement> element);
 
+  /**
+   * \brief Get the version of the packets this filter matches
+   * \return A counter moving whenever the filter or an element is changed
+   */
+  uint64_t GetRulesVersion(void) const;
+
 protected:
   /**
    * \brief Dispose of the object
@@ -53,6 +74,7 @@ protected:
 
 private:
   std::vector<Ptr<FilterElement>> m_elements;
+  uint64_t m_rulesVersion; //!< elements added
 };
 
 }
@@ -0,0 +1,141 @@
+#include "flow-cache.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowCache");
+
+FlowCache::FlowCache()
+    : m_entries(), m_mask(0), m_hand(0), m_hits(0), m_misses(0),
+      m_evictions(0)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void FlowCache::SetSize(uint32_t entries)
+{
+  NS_LOG_FUNCTION(this << entries);
+
+  uint32_t size = 0;
+  if (entries > 0)
+  {
+    size = PROBE_WINDOW;
+    while (size < entries)
+    {
+      size <<= 1;
+    }
+  }
+
+  m_entries.assign(size, Entry());
+  m_mask = (size > 0) ? size - 1 : 0;
+  m_hand = 0;
+  Clear();
+}
+
+uint32_t FlowCache::GetSize(void) const
+{
+  return m_entries.size();
+}
+
+bool FlowCache::Lookup(const FlowKey& key, uint32_t& classIndex)
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (m_entries.empty())
+  {
+    return false;
+  }
+
+  uint32_t home = key.Hash();
+  for (uint32_t i = 0; i < PROBE_WINDOW; i++)
+  {
+    Entry& entry = m_entries[(home + i) & m_mask];
+    if (!entry.valid)
+    {
+      break;
+    }
+    if (entry.key == key)
+    {
+      entry.referenced = true;
+      classIndex = entry.classIndex;
+      m_hits++;
+      NS_LOG_LOGIC("Flow cache hit, class " << classIndex);
+      return true;
+    }
+  }
+
+  m_misses++;
+  NS_LOG_LOGIC("Flow cache miss");
+  return false;
+}
+
+void FlowCache::Insert(const FlowKey& key, uint32_t classIndex)
+{
+  NS_LOG_FUNCTION(this << key << classIndex);
+
+  if (m_entries.empty())
+  {
+    return;
+  }
+
+  uint32_t home = key.Hash();
+  for (uint32_t i = 0; i < PROBE_WINDOW; i++)
+  {
+    Entry& entry = m_entries[(home + i) & m_mask];
+    if (!entry.valid)
+    {
+      entry.key = key;
+      entry.classIndex = classIndex;
+      entry.valid = true;
+      entry.referenced = false;
+      return;
+    }
+  }
+
+  // Window is full: sweep it from the hand, giving referenced entries a
+  // second chance.  Terminates within two passes.
+  for (;;)
+  {
+    Entry& entry = m_entries[(home + m_hand) & m_mask];
+    m_hand = (m_hand + 1) % PROBE_WINDOW;
+    if (entry.referenced)
+    {
+      entry.referenced = false;
+      continue;
+    }
+    NS_LOG_LOGIC("Evicting flow " << entry.key);
+    entry.key = key;
+    entry.classIndex = classIndex;
+    entry.referenced = false;
+    m_evictions++;
+    return;
+  }
+}
+
+void FlowCache::Clear(void)
+{
+  NS_LOG_FUNCTION(this);
+  for (uint32_t i = 0; i < m_entries.size(); i++)
+  {
+    m_entries[i].valid = false;
+    m_entries[i].referenced = false;
+  }
+}
+
+uint64_t FlowCache::GetHits(void) const
+{
+  return m_hits;
+}
+
+uint64_t FlowCache::GetMisses(void) const
+{
+  return m_misses;
+}
+
+uint64_t FlowCache::GetEvictions(void) const
+{
+  return m_evictions;
+}
+
+}
@@ -0,0 +1,97 @@
+#ifndef FLOW_CACHE_H
+#define FLOW_CACHE_H
+
+#include "flow-key.h"
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Bounded exact-match cache from flow to traffic class index
+ *
+ * Entries are keyed by the matchable fields of a FlowKey (5-tuple, DSCP
+ * and flags) and stored in a power-of-two open-addressed table.  A key
+ * may only live in the PROBE_WINDOW slots following its home slot; when
+ * all of them are taken, the victim is chosen within the window with the
+ * CLOCK (second chance) policy.  Entries are never removed individually,
+ * so no tombstones are needed.
+ */
+class FlowCache
+{
+public:
+  /// Number of slots a key may occupy, starting at its home slot
+  static const uint32_t PROBE_WINDOW = 8;
+
+  FlowCache();
+
+  /**
+   * \brief Resize the cache, dropping all entries
+   * \param entries The capacity, rounded up to a power of two; 0 disables
+   *        the cache
+   */
+  void SetSize(uint32_t entries);
+
+  /**
+   * \brief Get the capacity of the cache
+   * \return The number of slots
+   */
+  uint32_t GetSize(void) const;
+
+  /**
+   * \brief Look up the class of a flow
+   * \param key The classification key of the packet
+   * \param classIndex Output: the cached class index on a hit
+   * \return True on a hit
+   */
+  bool Lookup(const FlowKey& key, uint32_t& classIndex);
+
+  /**
+   * \brief Store the class of a flow, evicting another flow if needed
+   * \param key The classification key of the packet
+   * \param classIndex The class index resolved for the flow
+   */
+  void Insert(const FlowKey& key, uint32_t classIndex);
+
+  /**
+   * \brief Drop all entries, keeping the capacity and counters
+   */
+  void Clear(void);
+
+  /**
+   * \return The number of lookups that found their flow
+   */
+  uint64_t GetHits(void) const;
+
+  /**
+   * \return The number of lookups that did not find their flow
+   */
+  uint64_t GetMisses(void) const;
+
+  /**
+   * \return The number of entries replaced to make room for a new flow
+   */
+  uint64_t GetEvictions(void) const;
+
+private:
+  /// A cache slot
+  struct Entry
+  {
+    FlowKey key;         //!< cached flow
+    uint32_t classIndex; //!< class resolved for the flow
+    bool valid;          //!< slot holds a flow
+    bool referenced;     //!< CLOCK reference bit
+  };
+
+  std::vector<Entry> m_entries; //!< the slots
+  uint32_t m_mask;              //!< m_entries.size() - 1
+  uint32_t m_hand;              //!< CLOCK hand, as an offset in the window
+  uint64_t m_hits;              //!< lookup hits
+  uint64_t m_misses;            //!< lookup misses
+  uint64_t m_evictions;         //!< replaced entries
+};
+
+}
+
+#endif
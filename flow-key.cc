@@ -0,0 +1,193 @@
+#include "flow-key.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowKey");
+
+namespace
+{
+
+const uint8_t PPP_HEADER_SIZE = 2;      //!< PPP protocol field
+const uint8_t IPV4_MIN_HEADER_SIZE = 20; //!< IPv4 header without options
+const uint8_t IPV4_MAX_HEADER_SIZE = 60; //!< IPv4 header with all options
+const uint8_t PROTO_TCP = 6;
+const uint8_t PROTO_UDP = 17;
+
+uint16_t ReadU16(const uint8_t* buf)
+{
+  return static_cast<uint16_t>((buf[0] << 8) | buf[1]);
+}
+
+uint32_t ReadU32(const uint8_t* buf)
+{
+  return (static_cast<uint32_t>(buf[0]) << 24) |
+         (static_cast<uint32_t>(buf[1]) << 16) |
+         (static_cast<uint32_t>(buf[2]) << 8) | static_cast<uint32_t>(buf[3]);
+}
+
+}
+
+FlowKey FlowKey::Parse(Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(p);
+
+  FlowKey key = {};
+  key.size = p->GetSize();
+
+  // Enough for a PPP header, a full IPv4 header and both transport ports
+  uint8_t buf[PPP_HEADER_SIZE + IPV4_MAX_HEADER_SIZE + 4];
+  uint32_t len = p->CopyData(buf, sizeof(buf));
+
+  uint32_t offset = 0;
+  if (len >= PPP_HEADER_SIZE && ReadU16(buf) == 0x0021)
+  {
+    NS_LOG_LOGIC("Skipping PPP header");
+    offset = PPP_HEADER_SIZE;
+  }
+
+  if (len < offset + IPV4_MIN_HEADER_SIZE || (buf[offset] >> 4) != 4)
+  {
+    NS_LOG_LOGIC("No IPv4 header found");
+    return key;
+  }
+
+  const uint8_t* ip = buf + offset;
+  uint32_t headerSize = (ip[0] & 0x0f) * 4;
+  if (headerSize < IPV4_MIN_HEADER_SIZE || len < offset + headerSize)
+  {
+    NS_LOG_LOGIC("Truncated IPv4 header");
+    return key;
+  }
+
+  key.dscp = ip[1] >> 2;
+  key.ecn = ip[1] & 0x03;
+  key.protocol = ip[9];
+  key.source = ReadU32(ip + 12);
+  key.destination = ReadU32(ip + 16);
+  key.flags = IPV4;
+
+  // Ports are only present in the first fragment of a TCP or UDP datagram
+  uint16_t fragmentOffset = ReadU16(ip + 6) & 0x1fff;
+  if ((key.protocol == PROTO_TCP || key.protocol == PROTO_UDP) &&
+      fragmentOffset == 0 && len >= offset + headerSize + 4)
+  {
+    key.sourcePort = ReadU16(ip + headerSize);
+    key.destinationPort = ReadU16(ip + headerSize + 2);
+    key.flags |= PORTS;
+  }
+
+  NS_LOG_LOGIC("Parsed " << key);
+  return key;
+}
+
+FlowKey FlowKey::Mask(const FlowKey& mask) const
+{
+  FlowKey masked = {};
+  masked.source = source & mask.source;
+  masked.destination = destination & mask.destination;
+  masked.sourcePort = sourcePort & mask.sourcePort;
+  masked.destinationPort = destinationPort & mask.destinationPort;
+  masked.protocol = protocol & mask.protocol;
+  masked.dscp = dscp & mask.dscp;
+  masked.flags = flags & mask.flags;
+  return masked;
+}
+
+uint32_t FlowKey::Hash(void) const
+{
+  // 64-bit multiply-xorshift over the packed fields
+  uint64_t h = (static_cast<uint64_t>(source) << 32) | destination;
+  h ^= ((static_cast<uint64_t>(sourcePort) << 48) |
+        (static_cast<uint64_t>(destinationPort) << 32) |
+        (static_cast<uint64_t>(protocol) << 16) |
+        (static_cast<uint64_t>(dscp) << 8) | flags) *
+       0x9e3779b97f4a7c15ULL;
+  h ^= h >> 29;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 32;
+  return static_cast<uint32_t>(h);
+}
+
+bool operator==(const FlowKey& a, const FlowKey& b)
+{
+  return a.source == b.source && a.destination == b.destination &&
+         a.sourcePort == b.sourcePort &&
+         a.destinationPort == b.destinationPort &&
+         a.protocol == b.protocol && a.dscp == b.dscp && a.flags == b.flags;
+}
+
+FlowPattern FlowPattern::Any(void)
+{
+  FlowPattern pattern = {};
+  return pattern;
+}
+
+bool FlowPattern::Matches(const FlowKey& key) const
+{
+  return key.Mask(mask) == value;
+}
+
+namespace
+{
+
+template <typename T>
+bool IntersectField(T v1, T m1, T v2, T m2, T& v, T& m)
+{
+  if ((v1 ^ v2) & m1 & m2)
+  {
+    return false;
+  }
+  m = m1 | m2;
+  v = (v1 & m1) | (v2 & m2);
+  return true;
+}
+
+}
+
+bool FlowPattern::Intersect(const FlowPattern& other,
+                            FlowPattern& result) const
+{
+  FlowPattern r = {};
+  const FlowKey& v1 = value;
+  const FlowKey& m1 = mask;
+  const FlowKey& v2 = other.value;
+  const FlowKey& m2 = other.mask;
+
+  if (!IntersectField(v1.source, m1.source, v2.source, m2.source,
+                      r.value.source, r.mask.source) ||
+      !IntersectField(v1.destination, m1.destination, v2.destination,
+                      m2.destination, r.value.destination,
+                      r.mask.destination) ||
+      !IntersectField(v1.sourcePort, m1.sourcePort, v2.sourcePort,
+                      m2.sourcePort, r.value.sourcePort, r.mask.sourcePort) ||
+      !IntersectField(v1.destinationPort, m1.destinationPort,
+                      v2.destinationPort, m2.destinationPort,
+                      r.value.destinationPort, r.mask.destinationPort) ||
+      !IntersectField(v1.protocol, m1.protocol, v2.protocol, m2.protocol,
+                      r.value.protocol, r.mask.protocol) ||
+      !IntersectField(v1.dscp, m1.dscp, v2.dscp, m2.dscp, r.value.dscp,
+                      r.mask.dscp) ||
+      !IntersectField(v1.flags, m1.flags, v2.flags, m2.flags, r.value.flags,
+                      r.mask.flags))
+  {
+    return false;
+  }
+
+  result = r;
+  return true;
+}
+
+std::ostream& operator<<(std::ostream& os, const FlowKey& key)
+{
+  os << Ipv4Address(key.source) << ":" << key.sourcePort << " > "
+     << Ipv4Address(key.destination) << ":" << key.destinationPort
+     << " proto " << static_cast<uint32_t>(key.protocol) << " dscp "
+     << static_cast<uint32_t>(key.dscp) << " ecn "
+     << static_cast<uint32_t>(key.ecn) << " size " << key.size;
+  return os;
+}
+
+}
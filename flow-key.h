@@ -0,0 +1,137 @@
+#ifndef FLOW_KEY_H
+#define FLOW_KEY_H
+
+#include "ns3/packet.h"
+#include <ostream>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Compact classification key extracted from a packet
+ *
+ * DiffServ parses the IPv4 and transport headers of every arriving packet
+ * exactly once into a FlowKey; all filter elements then match against the
+ * key instead of copying and re-deserializing the packet themselves.
+ * Addresses are kept in host byte order, as returned by Ipv4Address::Get().
+ */
+struct FlowKey
+{
+  /// Bits of the flags field
+  enum Flags
+  {
+    IPV4 = 0x01,  //!< an IPv4 header was found
+    PORTS = 0x02, //!< sourcePort/destinationPort are valid (TCP or UDP)
+  };
+
+  uint32_t source;          //!< IPv4 source address
+  uint32_t destination;     //!< IPv4 destination address
+  uint16_t sourcePort;      //!< transport source port
+  uint16_t destinationPort; //!< transport destination port
+  uint8_t protocol;         //!< IPv4 protocol number
+  uint8_t dscp;             //!< DSCP codepoint (upper six bits of the TOS)
+  uint8_t ecn;              //!< ECN codepoint (lower two bits of the TOS)
+  uint8_t flags;            //!< combination of Flags
+  uint32_t size;            //!< total packet size in bytes
+
+  /**
+   * \brief Build the key for a packet
+   *
+   * Accepts packets starting either with the IPv4 header or with the PPP
+   * header that PointToPointNetDevice prepends before its TxQueue.  Only
+   * the first bytes of the packet are read; the packet itself is neither
+   * copied nor modified.
+   *
+   * \param p The packet to parse
+   * \return The key; flags is zero if no IPv4 header was found
+   */
+  static FlowKey Parse(Ptr<const Packet> p);
+
+  /**
+   * \brief Apply a mask to the matchable fields of this key
+   *
+   * The matchable fields are the addresses, ports, protocol, DSCP and
+   * flags; ecn and size are always cleared in the result.
+   *
+   * \param mask The mask to apply
+   * \return The masked key
+   */
+  FlowKey Mask(const FlowKey& mask) const;
+
+  /**
+   * \brief Hash the matchable fields of this key
+   * \return The hash value
+   */
+  uint32_t Hash(void) const;
+};
+
+/**
+ * \brief Compare the matchable fields of two keys
+ * \param a The first key
+ * \param b The second key
+ * \return True if addresses, ports, protocol, DSCP and flags are equal
+ */
+bool operator==(const FlowKey& a, const FlowKey& b);
+
+/**
+ * \brief Hash functor for using FlowKey in unordered containers
+ */
+struct FlowKeyHash
+{
+  /**
+   * \param key The key to hash
+   * \return The hash value
+   */
+  std::size_t operator()(const FlowKey& key) const
+  {
+    return key.Hash();
+  }
+};
+
+/**
+ * \ingroup diffserv
+ * \brief A ternary (value/mask) match on the matchable fields of a FlowKey
+ *
+ * A key matches the pattern iff key.Mask(mask) == value.  Filter elements
+ * describe themselves as a set of patterns so that the CompiledClassifier
+ * can index them.
+ */
+struct FlowPattern
+{
+  FlowKey value; //!< expected field values, already masked
+  FlowKey mask;  //!< bits of each field that must match
+
+  /**
+   * \brief Build the pattern matching every key
+   * \return The wildcard pattern
+   */
+  static FlowPattern Any(void);
+
+  /**
+   * \brief Check if a key matches this pattern
+   * \param key The key
+   * \return True on match
+   */
+  bool Matches(const FlowKey& key) const;
+
+  /**
+   * \brief Compute the pattern matching keys that match both patterns
+   * \param other The other pattern
+   * \param result Output: the combined pattern
+   * \return False if no key can match both patterns
+   */
+  bool Intersect(const FlowPattern& other, FlowPattern& result) const;
+};
+
+/**
+ * \brief Stream insertion operator for logging
+ * \param os The output stream
+ * \param key The key
+ * \return The output stream
+ */
+std::ostream& operator<<(std::ostream& os, const FlowKey& key);
+
+}
+
+#endif
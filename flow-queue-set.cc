@@ -0,0 +1,237 @@
+#include "flow-queue-set.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("FlowQueueSet");
+
+FlowQueueSet::FlowQueueSet()
+    : m_nodes(), m_freeNodes(NONE), m_flows(), m_quantum(1514), m_size(0),
+      m_lastFlow(0)
+{
+  m_newFlows.head = m_newFlows.tail = NONE;
+  m_oldFlows.head = m_oldFlows.tail = NONE;
+}
+
+void FlowQueueSet::SetNFlows(uint32_t nFlows)
+{
+  NS_LOG_FUNCTION(this << nFlows);
+
+  m_nodes.clear();
+  m_freeNodes = NONE;
+  m_size = 0;
+  m_lastFlow = 0;
+  m_newFlows.head = m_newFlows.tail = NONE;
+  m_oldFlows.head = m_oldFlows.tail = NONE;
+
+  Flow empty = {NONE, NONE, 0, 0, NONE, NO_LIST};
+  m_flows.assign(nFlows, empty);
+  if (nFlows == 0)
+  {
+    std::vector<Node>().swap(m_nodes);
+    std::vector<Flow>().swap(m_flows);
+  }
+}
+
+uint32_t FlowQueueSet::GetNFlows(void) const
+{
+  return m_flows.size();
+}
+
+void FlowQueueSet::SetQuantum(uint32_t quantum)
+{
+  NS_LOG_FUNCTION(this << quantum);
+  NS_ASSERT(quantum > 0);
+  m_quantum = quantum;
+}
+
+uint32_t FlowQueueSet::GetQuantum(void) const
+{
+  return m_quantum;
+}
+
+void FlowQueueSet::Append(List& list, uint32_t flow, ListId id) const
+{
+  m_flows[flow].next = NONE;
+  m_flows[flow].list = id;
+  if (list.tail == NONE)
+  {
+    list.head = flow;
+  }
+  else
+  {
+    m_flows[list.tail].next = flow;
+  }
+  list.tail = flow;
+}
+
+uint32_t FlowQueueSet::RemoveHead(List& list) const
+{
+  uint32_t flow = list.head;
+  list.head = m_flows[flow].next;
+  if (list.head == NONE)
+  {
+    list.tail = NONE;
+  }
+  m_flows[flow].next = NONE;
+  m_flows[flow].list = NO_LIST;
+  return flow;
+}
+
+void FlowQueueSet::Push(uint32_t flow, const QueuedPacket& item)
+{
+  NS_ASSERT(flow < m_flows.size());
+
+  uint32_t node;
+  if (m_freeNodes != NONE)
+  {
+    node = m_freeNodes;
+    m_freeNodes = m_nodes[node].next;
+  }
+  else
+  {
+    node = m_nodes.size();
+    m_nodes.push_back(Node());
+  }
+  m_nodes[node].item = item;
+  m_nodes[node].next = NONE;
+
+  Flow& f = m_flows[flow];
+  if (f.tail == NONE)
+  {
+    f.head = node;
+  }
+  else
+  {
+    m_nodes[f.tail].next = node;
+  }
+  f.tail = node;
+  f.bytes += item.packet->GetSize();
+  m_size++;
+  m_lastFlow = flow;
+
+  if (f.list == NO_LIST)
+  {
+    NS_LOG_LOGIC("Sub-queue " << flow << " joins the new flows");
+    f.deficit = m_quantum;
+    Append(m_newFlows, flow, NEW_FLOWS);
+  }
+}
+
+uint32_t FlowQueueSet::Select(void) const
+{
+  NS_ASSERT(m_size > 0);
+
+  while (true)
+  {
+    bool fromNew = m_newFlows.head != NONE;
+    List& list = fromNew ? m_newFlows : m_oldFlows;
+    NS_ASSERT_MSG(list.head != NONE, "Backlogged set without active flows");
+    uint32_t flow = list.head;
+    Flow& f = m_flows[flow];
+
+    if (f.deficit <= 0)
+    {
+      f.deficit += m_quantum;
+      RemoveHead(list);
+      Append(m_oldFlows, flow, OLD_FLOWS);
+      continue;
+    }
+
+    if (f.head == NONE)
+    {
+      // A drained new flow waits one round on the old list, so that a flow
+      // cannot regain priority by keeping just below one packet queued
+      RemoveHead(list);
+      if (fromNew && m_oldFlows.head != NONE)
+      {
+        Append(m_oldFlows, flow, OLD_FLOWS);
+      }
+      continue;
+    }
+
+    return flow;
+  }
+}
+
+QueuedPacket FlowQueueSet::PopFrom(uint32_t flow)
+{
+  Flow& f = m_flows[flow];
+  uint32_t node = f.head;
+  NS_ASSERT(node != NONE);
+
+  f.head = m_nodes[node].next;
+  if (f.head == NONE)
+  {
+    f.tail = NONE;
+  }
+
+  QueuedPacket item = m_nodes[node].item;
+  m_nodes[node].item = QueuedPacket();
+  m_nodes[node].next = m_freeNodes;
+  m_freeNodes = node;
+
+  f.bytes -= item.packet->GetSize();
+  m_size--;
+  return item;
+}
+
+QueuedPacket FlowQueueSet::Pop(void)
+{
+  uint32_t flow = Select();
+  QueuedPacket item = PopFrom(flow);
+  m_flows[flow].deficit -= item.packet->GetSize();
+  return item;
+}
+
+const QueuedPacket& FlowQueueSet::Front(void) const
+{
+  return m_nodes[m_flows[Select()].head].item;
+}
+
+const QueuedPacket& FlowQueueSet::Back(void) const
+{
+  NS_ASSERT(m_size > 0);
+
+  uint32_t tail = m_flows[m_lastFlow].tail;
+  if (tail == NONE)
+  {
+    tail = m_flows[Select()].tail;
+  }
+  return m_nodes[tail].item;
+}
+
+QueuedPacket FlowQueueSet::PopFromFattest(void)
+{
+  NS_ASSERT(m_size > 0);
+
+  // Only sub-queues on a list can hold packets
+  uint32_t fattest = NONE;
+  const List* lists[] = {&m_newFlows, &m_oldFlows};
+  for (uint32_t l = 0; l < 2; l++)
+  {
+    for (uint32_t flow = lists[l]->head; flow != NONE;
+         flow = m_flows[flow].next)
+    {
+      if (fattest == NONE || m_flows[flow].bytes > m_flows[fattest].bytes)
+      {
+        fattest = flow;
+      }
+    }
+  }
+
+  NS_LOG_LOGIC("Dropping from sub-queue " << fattest << " holding "
+                                          << m_flows[fattest].bytes
+                                          << " bytes");
+  return PopFrom(fattest);
+}
+
+void FlowQueueSet::Clear(void)
+{
+  NS_LOG_FUNCTION(this);
+  SetNFlows(m_flows.size());
+}
+
+}
@@ -0,0 +1,204 @@
+#ifndef FLOW_QUEUE_SET_H
+#define FLOW_QUEUE_SET_H
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include <list>
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/// Entry of a packet in the base list of the DiffServ queue storing it
+typedef std::list<Ptr<Packet>>::const_iterator PacketPosition;
+
+/**
+ * \ingroup diffserv
+ * \brief A packet stored in a traffic class, with its arrival time
+ *
+ * The position lets the DiffServ queue owning the class release the base
+ * queue entry of the packet without looking it up.
+ */
+struct QueuedPacket
+{
+  Ptr<Packet> packet;      //!< the packet
+  Time arrival;            //!< when the packet was enqueued
+  PacketPosition position; //!< base queue entry, set by the owning queue
+};
+
+/**
+ * \ingroup diffserv
+ * \brief Per-flow sub-queues served by byte-based DRR, FQ-CoDel style
+ *
+ * Packets of all sub-queues live in one pool of nodes linked by 32-bit
+ * indices, with a free list, so the pool stops allocating once it has
+ * grown to the class backlog.  A sub-queue costs 24 bytes whether it is
+ * used or not, which keeps tens of thousands of them per class cheap.
+ *
+ * Backlogged sub-queues sit on either the new-flows or the old-flows
+ * list.  A sub-queue that becomes backlogged joins the new-flows list,
+ * which is served first, so sparse flows get their first packets out
+ * ahead of the bulk flows cycling through the old-flows list.
+ */
+class FlowQueueSet
+{
+public:
+  FlowQueueSet();
+
+  /**
+   * \brief Set the number of sub-queues, discarding stored packets
+   * \param nFlows The number of sub-queues; 0 frees all memory
+   */
+  void SetNFlows(uint32_t nFlows);
+
+  /**
+   * \return The number of sub-queues
+   */
+  uint32_t GetNFlows(void) const;
+
+  /**
+   * \brief Set the DRR quantum
+   * \param quantum The bytes credited to a sub-queue per round
+   */
+  void SetQuantum(uint32_t quantum);
+
+  /**
+   * \return The DRR quantum in bytes
+   */
+  uint32_t GetQuantum(void) const;
+
+  /**
+   * \brief Append a packet to a sub-queue
+   * \param flow The sub-queue index, below GetNFlows()
+   * \param item The packet
+   */
+  void Push(uint32_t flow, const QueuedPacket& item);
+
+  /**
+   * \brief Remove the packet selected by the scheduler
+   * \return The packet; the set must not be empty
+   */
+  QueuedPacket Pop(void);
+
+  /**
+   * \brief Get the packet Pop would return
+   *
+   * Advances the round robin to the selected sub-queue, which Pop would
+   * do anyway; the scheduling state is mutable for that reason.
+   *
+   * \return The packet; the set must not be empty
+   */
+  const QueuedPacket& Front(void) const;
+
+  /**
+   * \brief Get a recently stored packet
+   * \return The last packet of the sub-queue that was fed last, or of an
+   *         arbitrary backlogged sub-queue if that one is empty
+   */
+  const QueuedPacket& Back(void) const;
+
+  /**
+   * \brief Remove the head packet of the sub-queue holding the most bytes
+   * \return The packet; the set must not be empty
+   */
+  QueuedPacket PopFromFattest(void);
+
+  /**
+   * \brief Discard all packets, keeping the sub-queues
+   */
+  void Clear(void);
+
+  /**
+   * \return The number of stored packets
+   */
+  uint32_t GetSize(void) const
+  {
+    return m_size;
+  }
+
+  /**
+   * \return True if no packet is stored
+   */
+  bool IsEmpty(void) const
+  {
+    return m_size == 0;
+  }
+
+private:
+  static const uint32_t NONE = 0xffffffff; //!< null index
+
+  /// Which list a sub-queue is on
+  enum ListId
+  {
+    NO_LIST,
+    NEW_FLOWS,
+    OLD_FLOWS,
+  };
+
+  /// A pool node
+  struct Node
+  {
+    QueuedPacket item; //!< the stored packet
+    uint32_t next;     //!< next node of the sub-queue, or of the free list
+  };
+
+  /// A sub-queue
+  struct Flow
+  {
+    uint32_t head;    //!< first node, or NONE
+    uint32_t tail;    //!< last node, or NONE
+    uint32_t bytes;   //!< bytes stored
+    int32_t deficit;  //!< DRR deficit
+    uint32_t next;    //!< next sub-queue on the same list
+    uint32_t list;    //!< ListId of the list holding this sub-queue
+  };
+
+  /// An intrusive FIFO of sub-queues
+  struct List
+  {
+    uint32_t head; //!< first sub-queue, or NONE
+    uint32_t tail; //!< last sub-queue, or NONE
+  };
+
+  /**
+   * \brief Find the sub-queue to serve, rotating the lists as DRR does
+   * \return The sub-queue index
+   */
+  uint32_t Select(void) const;
+
+  /**
+   * \brief Remove the head packet of a sub-queue
+   * \param flow The sub-queue index
+   * \return The packet
+   */
+  QueuedPacket PopFrom(uint32_t flow);
+
+  /**
+   * \brief Append a sub-queue to a list
+   * \param list The list
+   * \param flow The sub-queue index
+   * \param id The ListId of the list
+   */
+  void Append(List& list, uint32_t flow, ListId id) const;
+
+  /**
+   * \brief Remove the first sub-queue of a list
+   * \param list The list
+   * \return The sub-queue index
+   */
+  uint32_t RemoveHead(List& list) const;
+
+  std::vector<Node> m_nodes;         //!< packet pool
+  uint32_t m_freeNodes;              //!< first free node, or NONE
+  mutable std::vector<Flow> m_flows; //!< sub-queues
+  mutable List m_newFlows;           //!< sub-queues that recently became busy
+  mutable List m_oldFlows;           //!< other backlogged sub-queues
+  uint32_t m_quantum;                //!< DRR quantum in bytes
+  uint32_t m_size;                   //!< stored packets
+  uint32_t m_lastFlow;               //!< sub-queue of the last Push
+};
+
+}
+
+#endif
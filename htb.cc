@@ -0,0 +1,393 @@
+#include "htb.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "traffic-class.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("HTB");
+NS_OBJECT_ENSURE_REGISTERED(HTB);
+
+TypeId HTB::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::HTB")
+          .SetParent<DiffServ>()
+          .SetGroupName("Network")
+          .AddConstructor<HTB>()
+          .AddAttribute("Quantum",
+                        "The bytes a child of weight 1 is credited per round "
+                        "at round robin nodes",
+                        UintegerValue(1500),
+                        MakeUintegerAccessor(&HTB::m_quantum),
+                        MakeUintegerChecker<uint32_t>(1));
+  return tid;
+}
+
+HTB::HTB()
+    : DiffServ(), m_nodes(), m_leafOf(), m_quantum(1500),
+      m_nextEligible(Time::Max())
+{
+  NS_LOG_FUNCTION(this);
+  NewNode(0, NO_NODE, NO_NODE, STRICT_PRIORITY);
+}
+
+HTB::~HTB()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void HTB::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_nodes.clear();
+  m_leafOf.clear();
+  DiffServ::DoDispose();
+}
+
+uint32_t HTB::NewNode(Ptr<TrafficClass> tClass, uint32_t parent,
+                      uint32_t classIndex, Discipline discipline)
+{
+  Node node;
+  node.tClass = tClass;
+  node.parent = parent;
+  node.classIndex = classIndex;
+  node.discipline = discipline;
+  node.active = false;
+  node.inRound = false;
+  node.priority = 0;
+  node.deficit = 0;
+  node.nActive = 0;
+  m_nodes.push_back(node);
+  return m_nodes.size() - 1;
+}
+
+void HTB::AttachClasses(void)
+{
+  for (uint32_t i = m_leafOf.size(); i < m_classes.size(); i++)
+  {
+    NS_LOG_LOGIC("Attaching traffic class " << i << " below the root");
+    m_leafOf.push_back(NewNode(m_classes[i], ROOT, i, STRICT_PRIORITY));
+  }
+}
+
+uint32_t HTB::AddInnerNode(Ptr<TrafficClass> tClass, uint32_t parent,
+                           Discipline discipline)
+{
+  NS_LOG_FUNCTION(this << tClass << parent << discipline);
+  NS_ASSERT_MSG(parent < m_nodes.size() &&
+                    m_nodes[parent].classIndex == NO_NODE,
+                "The parent must be an inner node");
+  NS_ASSERT(tClass);
+  return NewNode(tClass, parent, NO_NODE, discipline);
+}
+
+uint32_t HTB::AddLeafNode(Ptr<TrafficClass> tClass, uint32_t parent)
+{
+  NS_LOG_FUNCTION(this << tClass << parent);
+  NS_ASSERT_MSG(parent < m_nodes.size() &&
+                    m_nodes[parent].classIndex == NO_NODE,
+                "The parent must be an inner node");
+
+  AttachClasses();
+  AddTrafficClass(tClass);
+  uint32_t node = NewNode(tClass, parent, m_classes.size() - 1,
+                          STRICT_PRIORITY);
+  m_leafOf.push_back(node);
+  return node;
+}
+
+void HTB::SetDiscipline(uint32_t node, Discipline discipline)
+{
+  NS_LOG_FUNCTION(this << node << discipline);
+  NS_ASSERT(node < m_nodes.size());
+  NS_ASSERT_MSG(m_nodes[node].nActive == 0 && m_nodes[node].round.empty(),
+                "Cannot change the discipline of a busy node");
+  m_nodes[node].discipline = discipline;
+}
+
+void HTB::SetNodeRate(uint32_t node, DataRate rate, uint32_t burst)
+{
+  NS_LOG_FUNCTION(this << node << rate << burst);
+  NS_ASSERT_MSG(node != ROOT && node < m_nodes.size(),
+                "The root is bounded by the link");
+  m_nodes[node].rate.SetRate(rate, burst);
+}
+
+void HTB::SetNodeCeil(uint32_t node, DataRate ceil, uint32_t burst)
+{
+  NS_LOG_FUNCTION(this << node << ceil << burst);
+  NS_ASSERT_MSG(node != ROOT && node < m_nodes.size(),
+                "The root is bounded by the link");
+  m_nodes[node].ceil.SetRate(ceil, burst);
+}
+
+uint32_t HTB::GetNNodes(void) const
+{
+  return m_nodes.size();
+}
+
+uint32_t HTB::GetLeafNode(uint32_t classIndex)
+{
+  AttachClasses();
+  NS_ASSERT(classIndex < m_leafOf.size());
+  return m_leafOf[classIndex];
+}
+
+void HTB::Activate(uint32_t id)
+{
+  Node& node = m_nodes[id];
+  Node& parent = m_nodes[node.parent];
+  node.active = true;
+  parent.nActive++;
+  if (parent.discipline == STRICT_PRIORITY)
+  {
+    node.priority = node.tClass->GetPriorityLevel();
+    parent.byPriority.insert(std::make_pair(node.priority, id));
+  }
+  else if (!node.inRound)
+  {
+    node.inRound = true;
+    node.deficit = 0;
+    parent.round.push_back(id);
+  }
+}
+
+void HTB::Deactivate(uint32_t id)
+{
+  Node& node = m_nodes[id];
+  Node& parent = m_nodes[node.parent];
+  node.active = false;
+  node.deficit = 0;
+  parent.nActive--;
+  if (parent.discipline == STRICT_PRIORITY)
+  {
+    parent.byPriority.erase(std::make_pair(node.priority, id));
+  }
+  // A round robin entry is dropped when the round reaches it
+}
+
+void HTB::NotifyEnqueue(uint32_t classIndex, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << classIndex << p);
+
+  AttachClasses();
+  uint32_t id = m_leafOf[classIndex];
+  while (id != ROOT && !m_nodes[id].active)
+  {
+    NS_LOG_LOGIC("Node " << id << " becomes backlogged");
+    Activate(id);
+    id = m_nodes[id].parent;
+  }
+}
+
+bool HTB::IsIdle(uint32_t id) const
+{
+  const Node& node = m_nodes[id];
+  if (node.classIndex != NO_NODE)
+  {
+    return m_classes[node.classIndex]->IsEmpty();
+  }
+  return node.nActive == 0;
+}
+
+HTB::Color HTB::GetColor(uint32_t id, Time now)
+{
+  Node& node = m_nodes[id];
+  Time hold(0);
+  if (node.classIndex != NO_NODE)
+  {
+    hold = m_classes[node.classIndex]->GetHoldTime();
+  }
+  if (node.ceil.IsEnabled() && node.ceil.GetTokens(now) < 0)
+  {
+    Time ceilHold = node.ceil.GetDelay(now, 0);
+    hold = (ceilHold > hold) ? ceilHold : hold;
+  }
+  if (hold.IsStrictlyPositive())
+  {
+    if (now + hold < m_nextEligible)
+    {
+      m_nextEligible = now + hold;
+    }
+    return RED;
+  }
+  if (node.rate.IsEnabled() && node.rate.GetTokens(now) >= 0)
+  {
+    return GREEN;
+  }
+  return YELLOW;
+}
+
+bool HTB::IsEligible(uint32_t id, uint32_t pass, Time now)
+{
+  Color color = GetColor(id, now);
+  return (color == GREEN) || (color == YELLOW && pass >= 1) || pass >= 2;
+}
+
+uint32_t HTB::SelectLeaf(uint32_t id, Time now)
+{
+  if (m_nodes[id].classIndex != NO_NODE)
+  {
+    return id;
+  }
+
+  // Holding packets back is only safe if the device will be woken up
+  uint32_t passes = CanHoldPackets() ? 2 : 3;
+  for (uint32_t pass = 0; pass < passes && m_nodes[id].nActive > 0; pass++)
+  {
+    uint32_t leaf = (m_nodes[id].discipline == STRICT_PRIORITY)
+                        ? SelectByPriority(id, pass, now)
+                        : SelectByRoundRobin(id, pass, now);
+    if (leaf != NO_NODE)
+    {
+      return leaf;
+    }
+  }
+  return NO_NODE;
+}
+
+uint32_t HTB::SelectByPriority(uint32_t id, uint32_t pass, Time now)
+{
+  std::set<std::pair<uint32_t, uint32_t>>& children = m_nodes[id].byPriority;
+  for (std::set<std::pair<uint32_t, uint32_t>>::iterator it = children.begin();
+       it != children.end();)
+  {
+    uint32_t child = it->second;
+    ++it;
+
+    if (IsIdle(child))
+    {
+      Deactivate(child);
+      continue;
+    }
+    if (!IsEligible(child, pass, now))
+    {
+      continue;
+    }
+    uint32_t leaf = SelectLeaf(child, now);
+    if (leaf != NO_NODE)
+    {
+      return leaf;
+    }
+    if (IsIdle(child))
+    {
+      Deactivate(child);
+    }
+  }
+  return NO_NODE;
+}
+
+uint32_t HTB::SelectByRoundRobin(uint32_t id, uint32_t pass, Time now)
+{
+  std::deque<uint32_t>& round = m_nodes[id].round;
+  uint32_t i = 0;
+  while (i < round.size())
+  {
+    uint32_t child = round[i];
+    Node& node = m_nodes[child];
+
+    if (node.active && IsIdle(child))
+    {
+      Deactivate(child);
+    }
+    if (!node.active)
+    {
+      node.inRound = false;
+      round.erase(round.begin() + i);
+      continue;
+    }
+    if (!IsEligible(child, pass, now))
+    {
+      i++;
+      continue;
+    }
+
+    uint32_t leaf = SelectLeaf(child, now);
+    if (leaf == NO_NODE)
+    {
+      if (IsIdle(child))
+      {
+        Deactivate(child);
+        continue;
+      }
+      i++;
+      continue;
+    }
+
+    uint32_t size =
+        m_classes[m_nodes[leaf].classIndex]->Peek()->GetSize();
+    if (node.deficit >= size)
+    {
+      return leaf;
+    }
+
+    // Credit the child and move it behind the others; deficits only grow
+    // until someone is served, so the loop ends
+    double quantum = node.tClass->GetWeight() * m_quantum;
+    node.deficit += (quantum < 1) ? 1 : static_cast<int64_t>(quantum);
+    round.erase(round.begin() + i);
+    round.push_back(child);
+  }
+  return NO_NODE;
+}
+
+void HTB::Charge(uint32_t leaf, uint32_t bytes, Time now)
+{
+  for (uint32_t id = leaf; id != ROOT; id = m_nodes[id].parent)
+  {
+    Node& node = m_nodes[id];
+    if (node.rate.IsEnabled())
+    {
+      node.rate.Consume(now, bytes);
+    }
+    if (node.ceil.IsEnabled())
+    {
+      node.ceil.Consume(now, bytes);
+    }
+    if (m_nodes[node.parent].discipline == DEFICIT_ROUND_ROBIN)
+    {
+      // Charged in full, even into the negative, so shares stay exact
+      node.deficit -= bytes;
+    }
+  }
+}
+
+Ptr<Packet> HTB::Schedule(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  AttachClasses();
+  Time now = Simulator::Now();
+  m_nextEligible = Time::Max();
+
+  while (true)
+  {
+    uint32_t leaf = SelectLeaf(ROOT, now);
+    if (leaf == NO_NODE)
+    {
+      if (m_nextEligible != Time::Max())
+      {
+        NS_LOG_LOGIC("All backlogged nodes above their ceiling until "
+                     << m_nextEligible);
+        ScheduleWake(m_nextEligible - now);
+      }
+      return 0;
+    }
+
+    uint32_t classIndex = m_nodes[leaf].classIndex;
+    Ptr<Packet> p = m_classes[classIndex]->Dequeue();
+    if (p)
+    {
+      NS_LOG_LOGIC("Scheduling from traffic class " << classIndex);
+      Charge(leaf, p->GetSize(), now);
+      return p;
+    }
+    // The AQM drained the class; the next selection prunes it
+  }
+}
+
+}
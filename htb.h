@@ -0,0 +1,260 @@
+#ifndef HTB_H
+#define HTB_H
+
+#include "diffserv.h"
+#include "ns3/data-rate.h"
+#include "token-bucket.h"
+#include <deque>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup queue
+ * \brief A hierarchical scheduler in the style of HTB
+ *
+ * The traffic classes of the DiffServ queue are the leaves of a tree whose
+ * inner nodes are TrafficClasses holding no packets.  Every inner node
+ * shares the link among its children by strict priority (on the children's
+ * PriorityLevel) or by byte-based deficit round robin (with a quantum of
+ * Quantum times the child's Weight).  Classes added with AddTrafficClass
+ * rather than AddLeafNode hang directly below the root.
+ *
+ * Every node but the root may have a guaranteed rate and a ceiling,
+ * enforced with lazily refilled token buckets charged with each packet
+ * sent from the node's subtree.  Within an inner node, children below
+ * their rate are served before children borrowing up to their ceiling,
+ * and children above their ceiling wait.  Waiting requires a wake
+ * callback (see DiffServ::SetWakeCallback); without one, ceilings are
+ * only enforced while some other child can be served.
+ *
+ * Each inner node keeps its backlogged children in a priority set or a
+ * round robin list, updated when a packet arrives in an idle subtree and
+ * when a subtree is found empty.  A decision therefore walks one path
+ * from the root to a leaf and costs O(depth) as long as the first child
+ * picked at each level is eligible, independently of the number of
+ * classes.
+ */
+class HTB : public DiffServ
+{
+public:
+  /// How an inner node shares the link among its children
+  enum Discipline
+  {
+    STRICT_PRIORITY,
+    DEFICIT_ROUND_ROBIN,
+  };
+
+  static const uint32_t ROOT = 0;             //!< the root node
+  static const uint32_t NO_NODE = 0xffffffff; //!< null node index
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Constructor
+   */
+  HTB();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~HTB();
+
+  virtual Ptr<Packet> Schedule(void) override;
+
+  /**
+   * \brief Add an inner node to the tree
+   * \param tClass Priority level and weight of the node within its parent;
+   *        it never holds packets and is not classified against
+   * \param parent The parent node, which must be an inner node
+   * \param discipline How the node shares the link among its children
+   * \return The node index
+   */
+  uint32_t AddInnerNode(Ptr<TrafficClass> tClass, uint32_t parent,
+                        Discipline discipline);
+
+  /**
+   * \brief Add a traffic class to this queue as a leaf of the tree
+   * \param tClass The traffic class
+   * \param parent The parent node, which must be an inner node
+   * \return The node index
+   */
+  uint32_t AddLeafNode(Ptr<TrafficClass> tClass, uint32_t parent);
+
+  /**
+   * \brief Set how an inner node shares the link among its children
+   * \param node The inner node; its subtree must be idle
+   * \param discipline The discipline
+   */
+  void SetDiscipline(uint32_t node, Discipline discipline);
+
+  /**
+   * \brief Guarantee a rate to a node
+   * \param node The node, other than the root
+   * \param rate The guaranteed rate; 0 removes the guarantee
+   * \param burst The bucket size in bytes, at least one MTU
+   */
+  void SetNodeRate(uint32_t node, DataRate rate, uint32_t burst);
+
+  /**
+   * \brief Cap the rate of a node, borrowing included
+   * \param node The node, other than the root
+   * \param ceil The ceiling; 0 removes the ceiling
+   * \param burst The bucket size in bytes, at least one MTU
+   */
+  void SetNodeCeil(uint32_t node, DataRate ceil, uint32_t burst);
+
+  /**
+   * \return The number of nodes, the root included
+   */
+  uint32_t GetNNodes(void) const;
+
+  /**
+   * \brief Get the leaf node of a traffic class
+   * \param classIndex The index of the traffic class
+   * \return The node index
+   */
+  uint32_t GetLeafNode(uint32_t classIndex);
+
+protected:
+  virtual void DoDispose(void) override;
+
+  /**
+   * \brief Mark the path from the class to the root as backlogged
+   * \param classIndex The index of the traffic class
+   * \param p The enqueued packet
+   */
+  virtual void NotifyEnqueue(uint32_t classIndex,
+                             Ptr<const Packet> p) override;
+
+private:
+  /// Position of a node with respect to its rate and ceiling
+  enum Color
+  {
+    GREEN,  //!< below its guaranteed rate
+    YELLOW, //!< borrowing, below its ceiling
+    RED,    //!< above its ceiling, or a leaf held by its shaper
+  };
+
+  /// A node of the tree
+  struct Node
+  {
+    Ptr<TrafficClass> tClass; //!< the class, holding packets for a leaf
+    uint32_t parent;          //!< parent node, NO_NODE for the root
+    uint32_t classIndex;      //!< traffic class index, NO_NODE if inner
+    Discipline discipline;    //!< discipline among the children
+    TokenBucket rate;         //!< guaranteed rate
+    TokenBucket ceil;         //!< ceiling
+    bool active;              //!< counted as backlogged by the parent
+    bool inRound;             //!< listed in the parent's round robin
+    uint32_t priority;        //!< priority level the parent sorted by
+    int64_t deficit;          //!< deficit in the parent's round robin
+    uint32_t nActive;         //!< backlogged children
+    /// backlogged children by (priority level, node)
+    std::set<std::pair<uint32_t, uint32_t>> byPriority;
+    /// round robin of children, may hold idle ones until visited
+    std::deque<uint32_t> round;
+  };
+
+  /**
+   * \brief Create a node
+   * \param tClass The traffic class
+   * \param parent The parent node
+   * \param classIndex The traffic class index, NO_NODE for an inner node
+   * \param discipline The discipline among the children
+   * \return The node index
+   */
+  uint32_t NewNode(Ptr<TrafficClass> tClass, uint32_t parent,
+                   uint32_t classIndex, Discipline discipline);
+
+  /**
+   * \brief Attach classes added with AddTrafficClass below the root
+   */
+  void AttachClasses(void);
+
+  /**
+   * \brief Enter a node in its parent's backlogged children
+   * \param node The node
+   */
+  void Activate(uint32_t node);
+
+  /**
+   * \brief Remove a node from its parent's backlogged children
+   * \param node The node
+   */
+  void Deactivate(uint32_t node);
+
+  /**
+   * \brief Check whether a node has nothing left to send
+   * \param node The node
+   * \return True if the leaf class or all children are empty
+   */
+  bool IsIdle(uint32_t node) const;
+
+  /**
+   * \brief Get the color of a node, noting when a red node turns yellow
+   * \param node The node
+   * \param now The current time
+   * \return The color
+   */
+  Color GetColor(uint32_t node, Time now);
+
+  /**
+   * \brief Check whether a child may be served in a selection pass
+   * \param node The child
+   * \param pass 0 for green children, 1 for yellow too, 2 for red too
+   * \param now The current time
+   * \return True if the child may be served
+   */
+  bool IsEligible(uint32_t node, uint32_t pass, Time now);
+
+  /**
+   * \brief Find the leaf to serve below a node
+   * \param node The node
+   * \param now The current time
+   * \return The leaf node, or NO_NODE if nothing may be sent
+   */
+  uint32_t SelectLeaf(uint32_t node, Time now);
+
+  /**
+   * \brief Find the leaf to serve below a strict priority node
+   * \param node The node
+   * \param pass The selection pass
+   * \param now The current time
+   * \return The leaf node, or NO_NODE
+   */
+  uint32_t SelectByPriority(uint32_t node, uint32_t pass, Time now);
+
+  /**
+   * \brief Find the leaf to serve below a round robin node
+   * \param node The node
+   * \param pass The selection pass
+   * \param now The current time
+   * \return The leaf node, or NO_NODE
+   */
+  uint32_t SelectByRoundRobin(uint32_t node, uint32_t pass, Time now);
+
+  /**
+   * \brief Charge a sent packet to the buckets and deficits of its path
+   * \param leaf The leaf node the packet left
+   * \param bytes The packet size
+   * \param now The current time
+   */
+  void Charge(uint32_t leaf, uint32_t bytes, Time now);
+
+  std::vector<Node> m_nodes;     //!< the tree, the root first
+  std::vector<uint32_t> m_leafOf; //!< leaf node of each traffic class
+  uint32_t m_quantum;            //!< round robin quantum for weight 1
+  Time m_nextEligible;           //!< earliest time a red node turns yellow
+};
+
+}
+
+#endif
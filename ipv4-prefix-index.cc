@@ -0,0 +1,107 @@
+#include "ipv4-prefix-index.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Ipv4PrefixIndex");
+
+Ipv4PrefixIndex::Ipv4PrefixIndex()
+    : m_nodes(), m_rootLengths(0), m_nPrefixes(0)
+{
+  NS_LOG_FUNCTION(this);
+  NewNode();
+}
+
+int32_t Ipv4PrefixIndex::NewNode(void)
+{
+  Node node;
+  for (uint32_t i = 0; i < FANOUT; i++)
+  {
+    node.slots[i].lengths = 0;
+    node.slots[i].child = -1;
+  }
+  m_nodes.push_back(node);
+  return m_nodes.size() - 1;
+}
+
+void Ipv4PrefixIndex::Insert(uint32_t prefix, uint8_t length)
+{
+  NS_LOG_FUNCTION(this << prefix << static_cast<uint32_t>(length));
+  NS_ASSERT(length <= 32);
+
+  m_nPrefixes++;
+  if (length == 0)
+  {
+    m_rootLengths |= 1;
+    return;
+  }
+
+  // Descend through the levels fully covered by the prefix
+  int32_t node = 0;
+  uint32_t level = 0;
+  while (length > STRIDE * (level + 1))
+  {
+    uint32_t byte = (prefix >> (32 - STRIDE * (level + 1))) & (FANOUT - 1);
+    if (m_nodes[node].slots[byte].child < 0)
+    {
+      int32_t child = NewNode();
+      m_nodes[node].slots[byte].child = child;
+    }
+    node = m_nodes[node].slots[byte].child;
+    level++;
+  }
+
+  // Expand the remaining 1..8 bits over the slots they cover
+  uint32_t remaining = length - STRIDE * level;
+  uint32_t byte = (prefix >> (32 - STRIDE * (level + 1))) & (FANOUT - 1);
+  uint32_t span = 1 << (STRIDE - remaining);
+  uint32_t first = byte & ~(span - 1);
+  for (uint32_t i = first; i < first + span; i++)
+  {
+    m_nodes[node].slots[i].lengths |= static_cast<uint64_t>(1) << length;
+  }
+}
+
+uint64_t Ipv4PrefixIndex::Lookup(uint32_t address) const
+{
+  uint64_t lengths = m_rootLengths;
+  int32_t node = 0;
+  for (uint32_t level = 0; node >= 0 && level < 32 / STRIDE; level++)
+  {
+    const Slot& slot =
+        m_nodes[node].slots[(address >> (32 - STRIDE * (level + 1))) &
+                            (FANOUT - 1)];
+    lengths |= slot.lengths;
+    node = slot.child;
+  }
+  return lengths;
+}
+
+int32_t Ipv4PrefixIndex::LongestMatch(uint64_t lengths)
+{
+  if (lengths == 0)
+  {
+    return -1;
+  }
+  return 63 - __builtin_clzll(lengths);
+}
+
+bool Ipv4PrefixIndex::GetPrefixLength(uint32_t mask, uint8_t& length)
+{
+  uint32_t inverted = ~mask;
+  if (inverted & (inverted + 1))
+  {
+    return false;
+  }
+  length = static_cast<uint8_t>(__builtin_popcount(mask));
+  return true;
+}
+
+uint32_t Ipv4PrefixIndex::GetNPrefixes(void) const
+{
+  return m_nPrefixes;
+}
+
+}
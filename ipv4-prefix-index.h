@@ -0,0 +1,92 @@
+#ifndef IPV4_PREFIX_INDEX_H
+#define IPV4_PREFIX_INDEX_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Longest-prefix-match index over a set of IPv4 prefixes
+ *
+ * A multibit trie with an 8-bit stride (DIR-style controlled prefix
+ * expansion): each node is a 256-slot array indexed by one address byte,
+ * and each slot carries the set of prefix lengths that cover it plus an
+ * optional child node.  Lookup() returns, for a given address, the set of
+ * lengths of all stored prefixes that contain it, in at most four memory
+ * accesses regardless of the number of prefixes.
+ */
+class Ipv4PrefixIndex
+{
+public:
+  Ipv4PrefixIndex();
+
+  /**
+   * \brief Add a prefix to the index
+   * \param prefix The prefix, in host byte order; bits past length ignored
+   * \param length The prefix length, 0 to 32
+   */
+  void Insert(uint32_t prefix, uint8_t length);
+
+  /**
+   * \brief Find the prefixes covering an address
+   * \param address The address, in host byte order
+   * \return A bitmap where bit L is set iff a stored prefix of length L
+   *         contains the address
+   */
+  uint64_t Lookup(uint32_t address) const;
+
+  /**
+   * \brief Get the length of the longest prefix in a Lookup() result
+   * \param lengths The result of Lookup()
+   * \return The longest length, or -1 if no prefix matched
+   */
+  static int32_t LongestMatch(uint64_t lengths);
+
+  /**
+   * \brief Check if a mask is a contiguous prefix mask
+   * \param mask The mask, in host byte order
+   * \param length Output: the prefix length when the mask is contiguous
+   * \return True if the mask consists of leading ones only
+   */
+  static bool GetPrefixLength(uint32_t mask, uint8_t& length);
+
+  /**
+   * \brief Get the number of prefixes inserted
+   * \return The number of Insert() calls
+   */
+  uint32_t GetNPrefixes(void) const;
+
+private:
+  static const uint32_t STRIDE = 8;             //!< bits per trie level
+  static const uint32_t FANOUT = 1 << STRIDE;   //!< slots per node
+
+  /// One slot of a trie node
+  struct Slot
+  {
+    uint64_t lengths; //!< lengths of prefixes covering this slot
+    int32_t child;    //!< index of the next level node, or -1
+  };
+
+  /// A trie node
+  struct Node
+  {
+    Slot slots[FANOUT]; //!< slots indexed by one address byte
+  };
+
+  /**
+   * \brief Append an empty node
+   * \return Its index in m_nodes
+   */
+  int32_t NewNode(void);
+
+  std::vector<Node> m_nodes; //!< trie nodes, m_nodes[0] is the root
+  uint64_t m_rootLengths;    //!< set if a zero-length prefix was added
+  uint32_t m_nPrefixes;      //!< number of inserted prefixes
+};
+
+}
+
+#endif
@@ -0,0 +1,317 @@
+#include "llq.h"
+#include "class-aqm.h"
+#include "cisco-parser.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "traffic-class.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LLQ");
+NS_OBJECT_ENSURE_REGISTERED(LLQ);
+
+TypeId LLQ::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::LLQ")
+          .SetParent<DRR>()
+          .SetGroupName("Network")
+          .AddConstructor<LLQ>()
+          .AddAttribute("Quantum",
+                        "The quantum of the round robin queues created from "
+                        "a Cisco configuration",
+                        UintegerValue(1500),
+                        MakeUintegerAccessor(&LLQ::m_quantum),
+                        MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute("PriorityRate",
+                        "The rate the priority queue created from a Cisco "
+                        "configuration is policed to",
+                        DataRateValue(DataRate("500kbps")),
+                        MakeDataRateAccessor(&LLQ::m_priorityRate),
+                        MakeDataRateChecker())
+          .AddAttribute("PriorityBurst",
+                        "The policer burst in bytes of the priority queue "
+                        "created from a Cisco configuration",
+                        UintegerValue(15000),
+                        MakeUintegerAccessor(&LLQ::m_priorityBurst),
+                        MakeUintegerChecker<uint32_t>(1));
+  return tid;
+}
+
+namespace
+{
+
+/// Orders class indices by priority level, lowest level first
+struct PriorityLess
+{
+  const std::vector<Ptr<TrafficClass>>& classes;
+
+  bool operator()(uint32_t a, uint32_t b) const
+  {
+    return classes[a]->GetPriorityLevel() < classes[b]->GetPriorityLevel();
+  }
+};
+
+}
+
+LLQ::LLQ()
+    : DRR(), m_priorityClasses(), m_isPriority(), m_quantum(1500),
+      m_priorityRate("500kbps"), m_priorityBurst(15000), m_configFile(""),
+      m_ciscoConfigFile(""), m_orderGeneration(0)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+LLQ::~LLQ()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void LLQ::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_priorityClasses.clear();
+  m_isPriority.clear();
+  DRR::DoDispose();
+}
+
+void LLQ::SetPriorityClass(uint32_t classIndex, DataRate rate, uint32_t burst)
+{
+  NS_LOG_FUNCTION(this << classIndex << rate << burst);
+  NS_ASSERT(classIndex < GetNTrafficClasses());
+
+  if (m_isPriority.size() <= classIndex)
+  {
+    m_isPriority.resize(classIndex + 1, false);
+  }
+  if (!m_isPriority[classIndex])
+  {
+    m_isPriority[classIndex] = true;
+    m_priorityClasses.push_back(classIndex);
+    // Take the class out of the round robin
+    SetQuantum(classIndex, 0);
+    SortPriorityClasses();
+  }
+
+  Ptr<TrafficClass> tClass = m_classes[classIndex];
+  if (rate.GetBitRate() != 0)
+  {
+    tClass->SetCir(rate);
+    tClass->SetCbs(burst);
+    tClass->SetRateMode(TrafficClass::RATE_POLICE);
+  }
+  else if (tClass->GetRateMode() == TrafficClass::RATE_POLICE)
+  {
+    tClass->SetRateMode(TrafficClass::RATE_UNLIMITED);
+  }
+}
+
+bool LLQ::IsPriorityClass(uint32_t classIndex) const
+{
+  return classIndex < m_isPriority.size() && m_isPriority[classIndex];
+}
+
+void LLQ::SortPriorityClasses(void)
+{
+  PriorityLess less = {m_classes};
+  std::stable_sort(m_priorityClasses.begin(), m_priorityClasses.end(), less);
+  m_orderGeneration = GetSchedulingGeneration();
+}
+
+void LLQ::NotifyEnqueue(uint32_t classIndex, Ptr<const Packet> p)
+{
+  if (IsPriorityClass(classIndex))
+  {
+    // Priority classes are found by scanning m_priorityClasses
+    return;
+  }
+  DRR::NotifyEnqueue(classIndex, p);
+}
+
+Ptr<Packet> LLQ::Schedule(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  if (m_orderGeneration != GetSchedulingGeneration())
+  {
+    SortPriorityClasses();
+  }
+
+  for (uint32_t i = 0; i < m_priorityClasses.size(); i++)
+  {
+    uint32_t classIndex = m_priorityClasses[i];
+    if (m_classes[classIndex]->IsEmpty())
+    {
+      continue;
+    }
+    if (!CanServe(classIndex))
+    {
+      NS_LOG_LOGIC("LLQ: Priority queue " << classIndex
+                                          << " held by its shaper");
+      continue;
+    }
+    Ptr<Packet> p = m_classes[classIndex]->Dequeue();
+    if (p)
+    {
+      NS_LOG_LOGIC("LLQ: Dequeued " << p->GetSize() << "B from priority queue "
+                                    << classIndex);
+      return p;
+    }
+  }
+
+  return DRR::Schedule();
+}
+
+bool LLQ::SetConfigFile(std::string filename)
+{
+  NS_LOG_FUNCTION(this << filename);
+  m_configFile = filename;
+  std::ifstream configFileStream(filename.c_str());
+  if (!configFileStream.is_open())
+  {
+    NS_LOG_ERROR("LLQ: Can't open LLQ config file: " << filename);
+    return false;
+  }
+
+  uint32_t numQueuesFromFile;
+  configFileStream >> numQueuesFromFile;
+  if (configFileStream.fail() || numQueuesFromFile == 0)
+  {
+    NS_LOG_ERROR("LLQ: Invalid number of queues in LLQ config file: "
+                 << filename << ". Read: " << numQueuesFromFile);
+    return false;
+  }
+
+  for (uint32_t i = GetNTrafficClasses(); i < numQueuesFromFile; ++i)
+  {
+    AddTrafficClass(CreateObject<TrafficClass>());
+  }
+
+  // One queue per line: "priority [rate [burst]]" or "quantum [aqm]"
+  std::string line;
+  for (uint32_t i = 0; i < numQueuesFromFile; ++i)
+  {
+    while (std::getline(configFileStream, line) &&
+           line.find_first_not_of(" \t\r") == std::string::npos)
+    {
+    }
+    std::istringstream lineStream(line);
+    std::string first;
+    lineStream >> first;
+    if (configFileStream.fail() || lineStream.fail())
+    {
+      NS_LOG_ERROR("LLQ: Missing line for queue "
+                   << i << " in LLQ config file: " << filename);
+      return false;
+    }
+
+    if (first == "priority")
+    {
+      DataRateValue rate(DataRate(0));
+      uint32_t burst = 15000;
+      std::string rateString;
+      if (lineStream >> rateString &&
+          !rate.DeserializeFromString(rateString, MakeDataRateChecker()))
+      {
+        NS_LOG_ERROR("LLQ: Invalid rate " << rateString << " for queue " << i
+                                          << " in LLQ config file: "
+                                          << filename);
+        return false;
+      }
+      std::string burstString;
+      if (lineStream >> burstString)
+      {
+        std::istringstream burstStream(burstString);
+        if (!(burstStream >> burst) || burst == 0)
+        {
+          NS_LOG_ERROR("LLQ: Invalid burst for queue "
+                       << i << " in LLQ config file: " << filename);
+          return false;
+        }
+      }
+      SetPriorityClass(i, rate.Get(), burst);
+      NS_LOG_INFO("LLQ: Queue " << i << " - Priority, policed to "
+                                << rate.Get() << " burst " << burst);
+      continue;
+    }
+
+    std::istringstream quantumStream(first);
+    uint32_t quantum = 0;
+    quantumStream >> quantum;
+    if (quantumStream.fail() || quantum == 0)
+    {
+      NS_LOG_ERROR("LLQ: Invalid quantum for queue "
+                   << i << " in LLQ config file: " << filename);
+      return false;
+    }
+    std::string aqmName;
+    if (lineStream >> aqmName)
+    {
+      Ptr<ClassAqm> aqm;
+      if (!ClassAqm::CreateFromName(aqmName, aqm))
+      {
+        NS_LOG_ERROR("LLQ: Invalid AQM " << aqmName << " for queue " << i
+                                         << " in LLQ config file: "
+                                         << filename);
+        return false;
+      }
+      GetTrafficClass(i)->SetAqm(aqm);
+    }
+    SetQuantum(i, quantum);
+    NS_LOG_INFO("LLQ: Queue " << i << " - Quantum: " << quantum);
+  }
+
+  NS_LOG_INFO("LLQ: Configuration loaded successfully from " << filename);
+  return true;
+}
+
+bool LLQ::SetCiscoConfigFile(std::string filename)
+{
+  NS_LOG_FUNCTION(this << filename);
+  m_ciscoConfigFile = filename;
+
+  Ptr<CiscoParser> parser = CreateObject<CiscoParser>();
+
+  uint32_t numQueues;
+  std::vector<uint32_t> priorities;
+
+  if (!parser->Parse(filename, numQueues, priorities))
+  {
+    NS_LOG_ERROR("Failed to parse Cisco configuration file " << filename);
+    return false;
+  }
+
+  uint32_t firstClass = GetNTrafficClasses();
+  std::vector<Ptr<TrafficClass>> classes;
+  for (uint32_t i = 0; i < numQueues; i++)
+  {
+    Ptr<TrafficClass> tClass = CreateObject<TrafficClass>();
+    tClass->SetPriorityLevel(priorities[i]);
+    AddTrafficClass(tClass);
+    classes.push_back(tClass);
+
+    // Queue 0 is the one "priority-queue out" expedites; police it so that
+    // it cannot starve the round robin queues
+    if (i == 0)
+    {
+      SetPriorityClass(firstClass, m_priorityRate, m_priorityBurst);
+    }
+    else
+    {
+      SetQuantum(firstClass + i, m_quantum);
+    }
+    NS_LOG_INFO("Added traffic class " << i << " with priority "
+                                       << priorities[i]);
+  }
+
+  // Classify by the trusted DSCP, the last queue catching the rest
+  parser->AddDscpFilters(classes);
+
+  return true;
+}
+
+}
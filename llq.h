@@ -0,0 +1,113 @@
+#ifndef LLQ_H
+#define LLQ_H
+
+#include "drr.h"
+#include "ns3/data-rate.h"
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup queue
+ * \brief Low Latency Queueing: strict priority classes in front of DRR
+ *
+ * Priority classes are always served first, in order of PriorityLevel,
+ * and the remaining classes share what is left by deficit round robin.
+ * A priority class may be given a rate, which sets up the class policer
+ * (see TrafficClass::SetRateMode) so that the priority traffic cannot
+ * starve the round robin classes.  This is the "priority-queue out"
+ * arrangement of Cisco edge configurations, where one egress queue is
+ * expedited and the others share the remaining bandwidth.
+ */
+class LLQ : public DRR
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Constructor
+   */
+  LLQ();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~LLQ();
+
+  virtual Ptr<Packet> Schedule(void) override;
+
+  /**
+   * \brief Serve a traffic class ahead of the round robin classes
+   * \param classIndex The index of the traffic class
+   * \param rate The rate the class is policed to; 0 leaves it unpoliced
+   * \param burst The policer bucket size in bytes
+   */
+  void SetPriorityClass(uint32_t classIndex, DataRate rate, uint32_t burst);
+
+  /**
+   * \param classIndex The index of the traffic class
+   * \return True if the class is served with strict priority
+   */
+  bool IsPriorityClass(uint32_t classIndex) const;
+
+  /**
+   * \brief Set the configuration file for LLQ.
+   *
+   * The file holds the number of queues, then one line per queue.  A
+   * priority queue reads "priority", optionally followed by its policed
+   * rate (e.g. 2Mbps) and burst in bytes; other queues read as in
+   * drr.config, a quantum optionally followed by an AQM name.
+   *
+   * \param filename The path to the configuration file.
+   * \return True if configuration was successful, false otherwise.
+   */
+  bool SetConfigFile(std::string filename);
+
+  /**
+   * \brief Set configuration from Cisco CLI configuration file
+   *
+   * Queue 0, enabled by "priority-queue out", is the priority queue,
+   * policed to PriorityRate with a PriorityBurst bucket, and the other
+   * queues share the link with a quantum of Quantum bytes.
+   *
+   * \param filename The Cisco CLI configuration file
+   * \return true if successful, false otherwise
+   */
+  bool SetCiscoConfigFile(std::string filename);
+
+protected:
+  virtual void DoDispose(void) override;
+
+  /**
+   * \brief Hand classes other than the priority ones to DRR
+   * \param classIndex The index of the traffic class
+   * \param p The enqueued packet
+   */
+  virtual void NotifyEnqueue(uint32_t classIndex,
+                             Ptr<const Packet> p) override;
+
+private:
+  /**
+   * \brief Order the priority classes by PriorityLevel
+   */
+  void SortPriorityClasses(void);
+
+  std::vector<uint32_t> m_priorityClasses; //!< by PriorityLevel
+  std::vector<bool> m_isPriority;          //!< class is a priority class
+  uint32_t m_quantum;                      //!< quantum of Cisco queues
+  DataRate m_priorityRate;                 //!< policed rate of Cisco queue 0
+  uint32_t m_priorityBurst;                //!< policer burst of Cisco queue 0
+  std::string m_configFile;
+  std::string m_ciscoConfigFile;
+  uint64_t m_orderGeneration;              //!< scheduling generation sorted at
+};
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+#include "multi-queue-diffserv.h"
+#include "compiled-classifier.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/net-device-queue-interface.h"
+#include "ns3/pointer.h"
+#include "ns3/queue-disc.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/uinteger.h"
+#include "traffic-class.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("MultiQueueDiffServ");
+NS_OBJECT_ENSURE_REGISTERED(MultiQueueDiffServ);
+
+TypeId MultiQueueDiffServ::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::MultiQueueDiffServ")
+          .SetParent<Object>()
+          .SetGroupName("TrafficControl")
+          .AddConstructor<MultiQueueDiffServ>()
+          .AddAttribute("Perturbation",
+                        "The salt of the 5-tuple hash steering packets to "
+                        "the transmission queues",
+                        UintegerValue(0),
+                        MakeUintegerAccessor(&MultiQueueDiffServ::m_perturbation),
+                        MakeUintegerChecker<uint32_t>());
+  return tid;
+}
+
+MultiQueueDiffServ::MultiQueueDiffServ()
+    : m_factory(), m_queues(), m_perturbation(0)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+MultiQueueDiffServ::~MultiQueueDiffServ()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void MultiQueueDiffServ::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_factory = Factory();
+  m_queues.clear();
+  Object::DoDispose();
+}
+
+void MultiQueueDiffServ::SetFactory(Factory factory)
+{
+  NS_LOG_FUNCTION(this);
+  m_factory = factory;
+}
+
+uint32_t MultiQueueDiffServ::Install(Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION(this << device);
+  NS_ABORT_MSG_IF(m_factory.IsNull(), "No factory for the DiffServ queues");
+  NS_ABORT_MSG_IF(!m_queues.empty(), "DiffServ queues already installed");
+
+  Ptr<NetDeviceQueueInterface> ndqi =
+      device->GetObject<NetDeviceQueueInterface>();
+  uint32_t nQueues = ndqi ? ndqi->GetNTxQueues() : 1;
+
+  for (uint32_t i = 0; i < nQueues; i++)
+  {
+    Ptr<DiffServ> queue = m_factory();
+    NS_ABORT_MSG_IF(!queue, "The factory created no DiffServ queue");
+    m_queues.push_back(queue);
+  }
+  ShareRules();
+
+  TrafficControlHelper tch;
+  tch.Uninstall(device);
+  if (nQueues == 1)
+  {
+    tch.SetRootQueueDisc("ns3::DiffServQueueDisc", "DiffServ",
+                         PointerValue(m_queues[0]));
+  }
+  else
+  {
+    uint16_t handle = tch.SetRootQueueDisc("ns3::MqQueueDisc");
+    TrafficControlHelper::ClassIdList classes =
+        tch.AddQueueDiscClasses(handle, nQueues, "ns3::QueueDiscClass");
+    for (uint32_t i = 0; i < nQueues; i++)
+    {
+      tch.AddChildQueueDisc(handle, classes[i], "ns3::DiffServQueueDisc",
+                            "DiffServ", PointerValue(m_queues[i]));
+    }
+    // Replaces any selection of the device, which would not keep the
+    // flows of a class on one queue
+    ndqi->SetSelectQueueCallback(
+        MakeCallback(&MultiQueueDiffServ::SelectQueue,
+                     Ptr<MultiQueueDiffServ>(this)));
+  }
+  tch.SetQueueLimits("ns3::DynamicQueueLimits");
+  tch.Install(device);
+
+  NS_LOG_INFO("Installed " << nQueues << " DiffServ queues");
+  return nQueues;
+}
+
+void MultiQueueDiffServ::ShareRules(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  if (m_queues.empty())
+  {
+    return;
+  }
+
+  std::vector<Ptr<TrafficClass>> classes;
+  for (uint32_t i = 0; i < m_queues[0]->GetNTrafficClasses(); i++)
+  {
+    classes.push_back(m_queues[0]->GetTrafficClass(i));
+  }
+  Ptr<CompiledClassifier> rules = CompiledClassifier::Compile(classes);
+  NS_LOG_LOGIC("Sharing " << (rules ? rules->GetNRules() : 0)
+                          << " compiled rules");
+
+  for (uint32_t i = 0; i < m_queues.size(); i++)
+  {
+    NS_ABORT_MSG_IF(m_queues[i]->GetNTrafficClasses() != classes.size(),
+                    "DiffServ queue " << i << " has different classes");
+    m_queues[i]->SetCompiledClassifier(rules);
+  }
+}
+
+std::size_t MultiQueueDiffServ::SelectQueue(Ptr<QueueItem> item) const
+{
+  Ptr<QueueDiscItem> qdItem = DynamicCast<QueueDiscItem>(item);
+  if (!qdItem || m_queues.empty())
+  {
+    return 0;
+  }
+  // Packets without a 5-tuple (not IP) hash to a constant
+  std::size_t index = qdItem->Hash(m_perturbation) % m_queues.size();
+  NS_LOG_LOGIC("Packet " << item << " steered to queue " << index);
+  return index;
+}
+
+uint32_t MultiQueueDiffServ::GetNQueues(void) const
+{
+  return m_queues.size();
+}
+
+Ptr<DiffServ> MultiQueueDiffServ::GetQueue(uint32_t index) const
+{
+  NS_ASSERT(index < m_queues.size());
+  return m_queues[index];
+}
+
+MultiQueueDiffServ::PortStats MultiQueueDiffServ::GetPortStats(void) const
+{
+  PortStats stats = {};
+  for (uint32_t i = 0; i < m_queues.size(); i++)
+  {
+    Ptr<DiffServ> queue = m_queues[i];
+    stats.nTotalReceivedPackets += queue->GetTotalReceivedPackets();
+    stats.nTotalReceivedBytes += queue->GetTotalReceivedBytes();
+    stats.nTotalDroppedPackets += queue->GetTotalDroppedPackets();
+    stats.nTotalDroppedBytes += queue->GetTotalDroppedBytes();
+    stats.nPackets += queue->GetNPackets();
+    stats.nBytes += queue->GetNBytes();
+  }
+  return stats;
+}
+
+MultiQueueDiffServ::ClassStats
+MultiQueueDiffServ::GetClassStats(uint32_t classIndex) const
+{
+  ClassStats stats = {};
+  for (uint32_t i = 0; i < m_queues.size(); i++)
+  {
+    NS_ABORT_MSG_IF(classIndex >= m_queues[i]->GetNTrafficClasses(),
+                    "DiffServ queue " << i << " has no traffic class "
+                                      << classIndex);
+    Ptr<TrafficClass> tClass = m_queues[i]->GetTrafficClass(classIndex);
+    stats.nPackets += tClass->GetNPackets();
+    stats.nBytes += tClass->GetNBytes();
+    stats.nOverflowDrops += tClass->GetNOverflowDrops();
+    stats.nPushOuts += tClass->GetNPushOuts();
+    stats.nTailDrops += tClass->GetNTailDrops();
+    stats.nAqmEnqueueDrops += tClass->GetNAqmEnqueueDrops();
+    stats.nAqmDequeueDrops += tClass->GetNAqmDequeueDrops();
+    stats.nEcnMarks += tClass->GetNEcnMarks();
+    stats.nPolicerDrops += tClass->GetNPolicerDrops();
+  }
+  return stats;
+}
+
+}
@@ -0,0 +1,135 @@
+#ifndef MULTI_QUEUE_DIFFSERV_H
+#define MULTI_QUEUE_DIFFSERV_H
+
+#include "diffserv.h"
+#include "ns3/callback.h"
+#include "ns3/net-device.h"
+#include "ns3/object.h"
+#include "ns3/queue-item.h"
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief One DiffServ queue per transmission queue of a multi-queue device
+ *
+ * Install creates a DiffServ queue for every transmission queue of the
+ * device's NetDeviceQueueInterface and installs them below an mq root
+ * queue disc, each as a DiffServQueueDisc, so that every device queue is
+ * classified, scheduled and woken up on its own.  Packets are steered to a
+ * transmission queue by a hash of their 5-tuple, which keeps the packets
+ * of a flow in order on one queue.  A single-queue device gets a single
+ * DiffServQueueDisc as its root queue disc.
+ *
+ * The queues are created by a factory callback and must be built with the
+ * same traffic classes and filters.  The rule set of the first one is
+ * compiled once and the immutable result is shared by all of them.
+ *
+ * GetPortStats and GetClassStats roll the statistics of the queues up into
+ * a view of the whole port.
+ */
+class MultiQueueDiffServ : public Object
+{
+public:
+  /// Creates the DiffServ queue of one transmission queue
+  typedef Callback<Ptr<DiffServ>> Factory;
+
+  /// Statistics of all the queues of the port
+  struct PortStats
+  {
+    uint64_t nTotalReceivedPackets; //!< packets offered to the queues
+    uint64_t nTotalReceivedBytes;   //!< bytes offered to the queues
+    uint64_t nTotalDroppedPackets;  //!< packets dropped by the queues
+    uint64_t nTotalDroppedBytes;    //!< bytes dropped by the queues
+    uint32_t nPackets;              //!< packets stored now
+    uint32_t nBytes;                //!< bytes stored now
+  };
+
+  /// Statistics of one traffic class, summed over all the queues
+  struct ClassStats
+  {
+    uint32_t nPackets;          //!< packets stored now
+    uint32_t nBytes;            //!< bytes stored now
+    uint64_t nOverflowDrops;    //!< packets refused by the class limits
+    uint64_t nPushOuts;         //!< packets pushed out for other classes
+    uint64_t nTailDrops;        //!< arrivals refused by a full buffer
+    uint64_t nAqmEnqueueDrops;  //!< packets dropped by the AQM at enqueue
+    uint64_t nAqmDequeueDrops;  //!< packets dropped by the AQM at dequeue
+    uint64_t nEcnMarks;         //!< packets marked CE
+    uint64_t nPolicerDrops;     //!< packets dropped by the policer
+  };
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  MultiQueueDiffServ();
+  virtual ~MultiQueueDiffServ();
+
+  /**
+   * \brief Set the callback creating the DiffServ queues
+   * \param factory The callback; every queue it returns must have the same
+   *        traffic classes and filters
+   */
+  void SetFactory(Factory factory);
+
+  /**
+   * \brief Replace the queue discs of a device by DiffServ queues
+   * \param device The device; any queue disc installed on it is removed
+   * \return The number of DiffServ queues installed
+   */
+  uint32_t Install(Ptr<NetDevice> device);
+
+  /**
+   * \brief Compile the rule set of the first queue and share it with all
+   *
+   * Install does it once; call it again after changing the traffic
+   * classes or filters of every queue, which otherwise compile their own.
+   */
+  void ShareRules(void);
+
+  /**
+   * \brief Select the transmission queue of a packet
+   * \param item The packet, as queued by the traffic control layer
+   * \return The transmission queue index
+   */
+  std::size_t SelectQueue(Ptr<QueueItem> item) const;
+
+  /**
+   * \return The number of DiffServ queues
+   */
+  uint32_t GetNQueues(void) const;
+
+  /**
+   * \param index The transmission queue index
+   * \return The DiffServ queue serving that transmission queue
+   */
+  Ptr<DiffServ> GetQueue(uint32_t index) const;
+
+  /**
+   * \return The statistics of the port
+   */
+  PortStats GetPortStats(void) const;
+
+  /**
+   * \param classIndex The traffic class; every queue must have it
+   * \return The statistics of the class over all the queues
+   */
+  ClassStats GetClassStats(uint32_t classIndex) const;
+
+protected:
+  virtual void DoDispose(void) override;
+
+private:
+  Factory m_factory;                   //!< creates the DiffServ queues
+  std::vector<Ptr<DiffServ>> m_queues; //!< one per transmission queue
+  uint32_t m_perturbation;             //!< salt of the steering hash
+};
+
+}
+
+#endif
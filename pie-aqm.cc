@@ -0,0 +1,173 @@
+#include "pie-aqm.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PieAqm");
+NS_OBJECT_ENSURE_REGISTERED(PieAqm);
+
+TypeId PieAqm::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::PieAqm")
+          .SetParent<ClassAqm>()
+          .SetGroupName("Network")
+          .AddConstructor<PieAqm>()
+          .AddAttribute("Target", "The reference queueing delay",
+                        TimeValue(MilliSeconds(15)),
+                        MakeTimeAccessor(&PieAqm::m_target), MakeTimeChecker())
+          .AddAttribute("TUpdate", "The period of the drop probability updates",
+                        TimeValue(MilliSeconds(15)),
+                        MakeTimeAccessor(&PieAqm::m_tUpdate), MakeTimeChecker())
+          .AddAttribute("A", "Weight of the delay error in the update (Hz)",
+                        DoubleValue(0.125), MakeDoubleAccessor(&PieAqm::m_a),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("B", "Weight of the delay trend in the update (Hz)",
+                        DoubleValue(1.25), MakeDoubleAccessor(&PieAqm::m_b),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("MaxBurst",
+                        "The burst allowed without drops after the queue "
+                        "has drained",
+                        TimeValue(MilliSeconds(150)),
+                        MakeTimeAccessor(&PieAqm::m_maxBurst),
+                        MakeTimeChecker());
+  return tid;
+}
+
+PieAqm::PieAqm()
+    : ClassAqm(), m_target(MilliSeconds(15)), m_tUpdate(MilliSeconds(15)),
+      m_a(0.125), m_b(1.25), m_maxBurst(MilliSeconds(150)), m_qDelay(Time(0)),
+      m_qDelayOld(Time(0)), m_burstAllowance(MilliSeconds(150)),
+      m_nextUpdate(Time(0)), m_dropProb(0)
+{
+  NS_LOG_FUNCTION(this);
+  m_uv = CreateObject<UniformRandomVariable>();
+}
+
+PieAqm::~PieAqm()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+int64_t PieAqm::AssignStreams(int64_t stream)
+{
+  NS_LOG_FUNCTION(this << stream);
+  m_uv->SetStream(stream);
+  return 1;
+}
+
+double PieAqm::GetDropProbability(void) const
+{
+  return m_dropProb;
+}
+
+void PieAqm::CalculateP(void)
+{
+  double error = (m_qDelay - m_target).GetSeconds();
+  double trend = (m_qDelay - m_qDelayOld).GetSeconds();
+  double delta = m_a * error + m_b * trend;
+
+  // Auto-tuning: small probabilities move in small steps
+  if (m_dropProb < 0.000001)
+  {
+    delta /= 2048;
+  }
+  else if (m_dropProb < 0.00001)
+  {
+    delta /= 512;
+  }
+  else if (m_dropProb < 0.0001)
+  {
+    delta /= 128;
+  }
+  else if (m_dropProb < 0.001)
+  {
+    delta /= 32;
+  }
+  else if (m_dropProb < 0.01)
+  {
+    delta /= 8;
+  }
+  else if (m_dropProb < 0.1)
+  {
+    delta /= 2;
+  }
+
+  m_dropProb += delta;
+  if (m_qDelay > MilliSeconds(250))
+  {
+    m_dropProb += 0.02;
+  }
+  m_dropProb = (m_dropProb < 0) ? 0 : (m_dropProb > 1) ? 1 : m_dropProb;
+
+  if (m_qDelay.IsZero() && m_qDelayOld.IsZero())
+  {
+    m_dropProb *= 0.98;
+  }
+
+  m_burstAllowance =
+      (m_burstAllowance > m_tUpdate) ? m_burstAllowance - m_tUpdate : Time(0);
+  if (m_dropProb == 0 && m_qDelay < m_target / int64_t(2) &&
+      m_qDelayOld < m_target / int64_t(2))
+  {
+    m_burstAllowance = m_maxBurst;
+  }
+  m_qDelayOld = m_qDelay;
+}
+
+ClassAqm::Verdict PieAqm::CheckEnqueue(Ptr<const Packet> p, uint32_t nPackets,
+                                       uint32_t nBytes)
+{
+  NS_LOG_FUNCTION(this << p << nPackets << nBytes);
+
+  Time now = Simulator::Now();
+  if (nPackets == 0)
+  {
+    m_qDelay = Time(0);
+  }
+  if (m_nextUpdate.IsZero())
+  {
+    m_nextUpdate = now + m_tUpdate;
+  }
+  while (now >= m_nextUpdate)
+  {
+    CalculateP();
+    m_nextUpdate += m_tUpdate;
+    if (m_dropProb == 0 && m_qDelay.IsZero())
+    {
+      // Nothing more can change until traffic returns
+      m_nextUpdate = now + m_tUpdate;
+    }
+  }
+
+  if (m_burstAllowance.IsStrictlyPositive())
+  {
+    return ACCEPT;
+  }
+  if (m_qDelayOld < m_target / int64_t(2) && m_dropProb < 0.2)
+  {
+    return ACCEPT;
+  }
+  if (nPackets <= 2)
+  {
+    return ACCEPT;
+  }
+  if (m_uv->GetValue() < m_dropProb)
+  {
+    NS_LOG_LOGIC("Early drop, probability " << m_dropProb);
+    return DROP;
+  }
+  return ACCEPT;
+}
+
+ClassAqm::Verdict PieAqm::CheckDequeue(Ptr<const Packet> p, Time sojourn,
+                                       uint32_t nPackets, uint32_t nBytes)
+{
+  m_qDelay = sojourn;
+  return ACCEPT;
+}
+
+}
@@ -0,0 +1,71 @@
+#ifndef PIE_AQM_H
+#define PIE_AQM_H
+
+#include "class-aqm.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Proportional Integral controller Enhanced (RFC 8033) for a class
+ *
+ * Drops arrivals with a probability driven by the queueing delay, which is
+ * taken from the sojourn time of departing packets.  The probability is
+ * updated every TUpdate; instead of running a timer per class, the updates
+ * that fell due are caught up lazily on the next arrival.
+ */
+class PieAqm : public ClassAqm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Constructor
+   */
+  PieAqm();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~PieAqm();
+
+  virtual Verdict CheckEnqueue(Ptr<const Packet> p, uint32_t nPackets,
+                               uint32_t nBytes) override;
+  virtual Verdict CheckDequeue(Ptr<const Packet> p, Time sojourn,
+                               uint32_t nPackets, uint32_t nBytes) override;
+  virtual int64_t AssignStreams(int64_t stream) override;
+
+  /**
+   * \brief Get the current drop probability
+   * \return The probability
+   */
+  double GetDropProbability(void) const;
+
+private:
+  /**
+   * \brief Run one periodic update of the drop probability
+   */
+  void CalculateP(void);
+
+  Time m_target;                   //!< reference queueing delay
+  Time m_tUpdate;                  //!< period of the probability updates
+  double m_a;                      //!< weight of the delay error (Hz)
+  double m_b;                      //!< weight of the delay trend (Hz)
+  Time m_maxBurst;                 //!< burst allowance after an idle queue
+  Time m_qDelay;                   //!< current queueing delay estimate
+  Time m_qDelayOld;                //!< delay estimate at the last update
+  Time m_burstAllowance;           //!< remaining burst allowance
+  Time m_nextUpdate;               //!< when the next update falls due
+  double m_dropProb;               //!< current drop probability
+  Ptr<UniformRandomVariable> m_uv; //!< drop decisions
+};
+
+}
+
+#endif
@@ -0,0 +1,69 @@
+#include "port-bitmap.h"
+
+namespace ns3
+{
+
+PortBitmap::PortBitmap() : m_words(N_PORTS / 64, 0)
+{
+}
+
+void PortBitmap::AddRange(uint16_t first, uint16_t last)
+{
+  for (uint32_t port = first; port <= last; port++)
+  {
+    m_words[port >> 6] |= static_cast<uint64_t>(1) << (port & 63);
+  }
+}
+
+void PortBitmap::Clear(void)
+{
+  m_words.assign(N_PORTS / 64, 0);
+}
+
+bool PortBitmap::IsEmpty(void) const
+{
+  for (uint32_t i = 0; i < m_words.size(); i++)
+  {
+    if (m_words[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PortBitmap::GetBlocks(std::vector<uint16_t>& values,
+                           std::vector<uint16_t>& masks) const
+{
+  uint32_t port = 0;
+  while (port < N_PORTS)
+  {
+    if (!Contains(port))
+    {
+      port++;
+      continue;
+    }
+
+    // Find the run [port, end) and cut it into aligned blocks
+    uint32_t end = port;
+    while (end < N_PORTS && Contains(end))
+    {
+      end++;
+    }
+
+    while (port < end)
+    {
+      uint32_t size = 1;
+      while (size < N_PORTS && (port & (size * 2 - 1)) == 0 &&
+             port + size * 2 <= end)
+      {
+        size *= 2;
+      }
+      values.push_back(static_cast<uint16_t>(port));
+      masks.push_back(static_cast<uint16_t>(~(size - 1)));
+      port += size;
+    }
+  }
+}
+
+}
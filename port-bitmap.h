@@ -0,0 +1,72 @@
+#ifndef PORT_BITMAP_H
+#define PORT_BITMAP_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Set of transport ports stored as a 64K-entry bitmap
+ *
+ * Membership is a single bit test whatever the number or width of the
+ * ranges added, so a rule such as 1024-65535 costs the same as a single
+ * port.
+ */
+class PortBitmap
+{
+public:
+  PortBitmap();
+
+  /**
+   * \brief Add an inclusive range of ports to the set
+   * \param first The first port of the range
+   * \param last The last port of the range
+   */
+  void AddRange(uint16_t first, uint16_t last);
+
+  /**
+   * \brief Remove all ports from the set
+   */
+  void Clear(void);
+
+  /**
+   * \brief Check if a port is in the set
+   * \param port The port
+   * \return True if the port was added
+   */
+  bool Contains(uint16_t port) const
+  {
+    return (m_words[port >> 6] >> (port & 63)) & 1;
+  }
+
+  /**
+   * \brief Check if the set is empty
+   * \return True if no port was added
+   */
+  bool IsEmpty(void) const;
+
+  /**
+   * \brief Decompose the set into aligned power-of-two blocks
+   *
+   * Each block is returned as a value/mask pair such that a port belongs
+   * to the block iff (port & mask) == value.  An arbitrary range needs at
+   * most 30 blocks.
+   *
+   * \param values Output: the block base values
+   * \param masks Output: the block masks
+   */
+  void GetBlocks(std::vector<uint16_t>& values,
+                 std::vector<uint16_t>& masks) const;
+
+private:
+  static const uint32_t N_PORTS = 65536; //!< number of representable ports
+
+  std::vector<uint64_t> m_words; //!< one bit per port
+};
+
+}
+
+#endif
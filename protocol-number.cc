@@ -0,0 +1,86 @@
+#include "protocol-number.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("ProtocolNumber");
+NS_OBJECT_ENSURE_REGISTERED(ProtocolNumber);
+
+TypeId ProtocolNumber::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::ProtocolNumber")
+          .SetParent<FilterElement>()
+          .SetGroupName("Network")
+          .AddConstructor<ProtocolNumber>()
+          .AddAttribute("Protocol", "The IPv4 protocol number to match",
+                        UintegerValue(6),
+                        MakeUintegerAccessor(&ProtocolNumber::SetProtocol,
+                                             &ProtocolNumber::GetProtocol),
+                        MakeUintegerChecker<uint8_t>());
+  return tid;
+}
+
+ProtocolNumber::ProtocolNumber() : m_protocol(6)
+{
+  NS_LOG_FUNCTION(this);
+}
+
+ProtocolNumber::ProtocolNumber(uint8_t protocol) : m_protocol(protocol)
+{
+  NS_LOG_FUNCTION(this << static_cast<uint32_t>(protocol));
+}
+
+ProtocolNumber::~ProtocolNumber()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void ProtocolNumber::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  FilterElement::DoDispose();
+}
+
+bool ProtocolNumber::Match(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (key.flags & FlowKey::IPV4)
+  {
+    return key.protocol == m_protocol;
+  }
+
+  NS_LOG_LOGIC("Packet doesn't have an IPv4 header");
+  return false;
+}
+
+bool ProtocolNumber::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  FlowPattern pattern = FlowPattern::Any();
+  pattern.value.protocol = m_protocol;
+  pattern.mask.protocol = 0xff;
+  pattern.value.flags = FlowKey::IPV4;
+  pattern.mask.flags = FlowKey::IPV4;
+  patterns.push_back(pattern);
+  return true;
+}
+
+void ProtocolNumber::SetProtocol(uint8_t protocol)
+{
+  NS_LOG_FUNCTION(this << static_cast<uint32_t>(protocol));
+  m_protocol = protocol;
+  NotifyRulesChanged();
+}
+
+uint8_t ProtocolNumber::GetProtocol(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_protocol;
+}
+
+}
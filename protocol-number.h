@@ -0,0 +1,74 @@
+#ifndef PROTOCOL_NUMBER_H
+#define PROTOCOL_NUMBER_H
+
+#include "filter-element.h"
+
+namespace ns3
+{
+
+/**
+ * \brief Filter element for the IPv4 protocol number
+ */
+class ProtocolNumber : public FilterElement
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Default constructor, matches TCP
+   */
+  ProtocolNumber();
+
+  /**
+   * \brief Constructor with protocol number
+   * \param protocol The IPv4 protocol number to match (6 TCP, 17 UDP, ...)
+   */
+  ProtocolNumber(uint8_t protocol);
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~ProtocolNumber();
+
+  /**
+   * \brief Check if a packet matches this filter element
+   * \param key The classification key parsed from the packet
+   * \return True if the packet carries the configured protocol
+   */
+  virtual bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe this element as an exact match on the protocol
+   * \param patterns Output: the patterns
+   * \return Always true
+   */
+  virtual bool GetPatterns(std::vector<FlowPattern>& patterns) const;
+
+  /**
+   * \brief Set the protocol number to match
+   * \param protocol The IPv4 protocol number
+   */
+  void SetProtocol(uint8_t protocol);
+
+  /**
+   * \brief Get the protocol number to match
+   * \return The IPv4 protocol number
+   */
+  uint8_t GetProtocol(void) const;
+
+private:
+  uint8_t m_protocol; //!< The IPv4 protocol number to match
+
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose(void);
+};
+
+}
+
+#endif
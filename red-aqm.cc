@@ -0,0 +1,113 @@
+#include "red-aqm.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("RedAqm");
+NS_OBJECT_ENSURE_REGISTERED(RedAqm);
+
+TypeId RedAqm::GetTypeId(void)
+{
+  static TypeId tid =
+      TypeId("ns3::RedAqm")
+          .SetParent<ClassAqm>()
+          .SetGroupName("Network")
+          .AddConstructor<RedAqm>()
+          .AddAttribute("MinTh", "Average length (packets) where drops start",
+                        DoubleValue(5), MakeDoubleAccessor(&RedAqm::m_minTh),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("MaxTh",
+                        "Average length (packets) where the drop probability "
+                        "reaches MaxP",
+                        DoubleValue(15), MakeDoubleAccessor(&RedAqm::m_maxTh),
+                        MakeDoubleChecker<double>(0.0))
+          .AddAttribute("MaxP", "Drop probability at MaxTh", DoubleValue(0.1),
+                        MakeDoubleAccessor(&RedAqm::m_maxP),
+                        MakeDoubleChecker<double>(0.0, 1.0))
+          .AddAttribute("QW", "Weight of the average length EWMA",
+                        DoubleValue(0.002), MakeDoubleAccessor(&RedAqm::m_qW),
+                        MakeDoubleChecker<double>(0.0, 1.0))
+          .AddAttribute("Gentle",
+                        "Raise the drop probability from MaxP to 1 between "
+                        "MaxTh and 2 * MaxTh instead of dropping everything",
+                        BooleanValue(true),
+                        MakeBooleanAccessor(&RedAqm::m_gentle),
+                        MakeBooleanChecker());
+  return tid;
+}
+
+RedAqm::RedAqm()
+    : ClassAqm(), m_minTh(5), m_maxTh(15), m_maxP(0.1), m_qW(0.002),
+      m_gentle(true), m_average(0), m_count(-1)
+{
+  NS_LOG_FUNCTION(this);
+  m_uv = CreateObject<UniformRandomVariable>();
+}
+
+RedAqm::~RedAqm()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+int64_t RedAqm::AssignStreams(int64_t stream)
+{
+  NS_LOG_FUNCTION(this << stream);
+  m_uv->SetStream(stream);
+  return 1;
+}
+
+double RedAqm::GetAverage(void) const
+{
+  return m_average;
+}
+
+ClassAqm::Verdict RedAqm::CheckEnqueue(Ptr<const Packet> p, uint32_t nPackets,
+                                       uint32_t nBytes)
+{
+  NS_LOG_FUNCTION(this << p << nPackets << nBytes);
+
+  m_average = (1 - m_qW) * m_average + m_qW * nPackets;
+
+  double pb;
+  if (m_average < m_minTh)
+  {
+    m_count = -1;
+    return ACCEPT;
+  }
+  else if (m_average < m_maxTh)
+  {
+    pb = m_maxP * (m_average - m_minTh) / (m_maxTh - m_minTh);
+  }
+  else if (m_gentle && m_average < 2 * m_maxTh)
+  {
+    pb = m_maxP + (1 - m_maxP) * (m_average - m_maxTh) / m_maxTh;
+  }
+  else
+  {
+    NS_LOG_LOGIC("Average " << m_average << " above the maximum threshold");
+    m_count = 0;
+    return DROP;
+  }
+
+  m_count++;
+  double pa = (m_count * pb < 1) ? pb / (1 - m_count * pb) : 1;
+  if (m_uv->GetValue() < pa)
+  {
+    NS_LOG_LOGIC("Early drop, average " << m_average << " probability "
+                                        << pa);
+    m_count = 0;
+    return DROP;
+  }
+  return ACCEPT;
+}
+
+ClassAqm::Verdict RedAqm::CheckDequeue(Ptr<const Packet> p, Time sojourn,
+                                       uint32_t nPackets, uint32_t nBytes)
+{
+  return ACCEPT;
+}
+
+}
@@ -0,0 +1,63 @@
+#ifndef RED_AQM_H
+#define RED_AQM_H
+
+#include "class-aqm.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief Random Early Detection for a traffic class
+ *
+ * Floyd and Jacobson's RED in packet mode: an EWMA of the class length is
+ * kept on arrivals, packets are dropped with a probability rising linearly
+ * from MinTh to MaxTh (and, in gentle mode, on to 2 * MaxTh), spread out by
+ * the count of packets accepted since the last drop.
+ */
+class RedAqm : public ClassAqm
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Constructor
+   */
+  RedAqm();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~RedAqm();
+
+  virtual Verdict CheckEnqueue(Ptr<const Packet> p, uint32_t nPackets,
+                               uint32_t nBytes) override;
+  virtual Verdict CheckDequeue(Ptr<const Packet> p, Time sojourn,
+                               uint32_t nPackets, uint32_t nBytes) override;
+  virtual int64_t AssignStreams(int64_t stream) override;
+
+  /**
+   * \brief Get the average class length
+   * \return The average, in packets
+   */
+  double GetAverage(void) const;
+
+private:
+  double m_minTh;                     //!< packets, start of early drops
+  double m_maxTh;                     //!< packets, end of the linear region
+  double m_maxP;                      //!< drop probability at MaxTh
+  double m_qW;                        //!< EWMA weight
+  bool m_gentle;                      //!< ramp to 1 between MaxTh and 2*MaxTh
+  double m_average;                   //!< average class length
+  int32_t m_count;                    //!< packets since the last drop, or -1
+  Ptr<UniformRandomVariable> m_uv;    //!< drop decisions
+};
+
+}
+
+#endif
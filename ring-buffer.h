@@ -0,0 +1,176 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief FIFO stored contiguously in a power-of-two circular array
+ *
+ * Slots are allocated up front by Reserve, so that Push and Pop never touch
+ * the allocator while the backlog stays within the reserved capacity.  When
+ * a Push finds the array full it doubles the capacity, which keeps the
+ * buffer usable if the owner's limit was raised after the last Reserve.
+ *
+ * \tparam T The element type; must be default-constructible.  Popped slots
+ * are reset to T() so that smart pointers release their object.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  RingBuffer() : m_slots(), m_head(0), m_size(0), m_mask(0)
+  {
+  }
+
+  /**
+   * \brief Make room for at least a given number of elements
+   *
+   * Never shrinks the buffer.  Stored elements keep their order.
+   *
+   * \param capacity The number of elements
+   */
+  void Reserve(uint32_t capacity)
+  {
+    if (capacity <= m_slots.size())
+    {
+      return;
+    }
+    uint32_t newSize = 1;
+    while (newSize < capacity)
+    {
+      newSize <<= 1;
+    }
+
+    std::vector<T> slots(newSize);
+    for (uint32_t i = 0; i < m_size; i++)
+    {
+      slots[i] = std::move(m_slots[(m_head + i) & m_mask]);
+    }
+    m_slots.swap(slots);
+    m_head = 0;
+    m_mask = newSize - 1;
+  }
+
+  /**
+   * \brief Append an element at the tail
+   * \param item The element
+   */
+  void Push(const T& item)
+  {
+    if (m_size == m_slots.size())
+    {
+      Reserve(m_slots.empty() ? 1 : 2 * m_slots.size());
+    }
+    m_slots[(m_head + m_size) & m_mask] = item;
+    m_size++;
+  }
+
+  /**
+   * \brief Remove the element at the head
+   * \return The removed element
+   */
+  T Pop(void)
+  {
+    NS_ASSERT(m_size > 0);
+    T item = std::move(m_slots[m_head]);
+    m_slots[m_head] = T();
+    m_head = (m_head + 1) & m_mask;
+    m_size--;
+    return item;
+  }
+
+  /**
+   * \brief Remove the element at the tail
+   * \return The removed element
+   */
+  T PopTail(void)
+  {
+    NS_ASSERT(m_size > 0);
+    m_size--;
+    uint32_t tail = (m_head + m_size) & m_mask;
+    T item = std::move(m_slots[tail]);
+    m_slots[tail] = T();
+    return item;
+  }
+
+  /**
+   * \return The element at the head
+   */
+  const T& Front(void) const
+  {
+    NS_ASSERT(m_size > 0);
+    return m_slots[m_head];
+  }
+
+  /**
+   * \return The element at the tail
+   */
+  const T& Back(void) const
+  {
+    NS_ASSERT(m_size > 0);
+    return m_slots[(m_head + m_size - 1) & m_mask];
+  }
+
+  /**
+   * \param i Position from the head, 0 being the head itself
+   * \return The element at that position
+   */
+  const T& At(uint32_t i) const
+  {
+    NS_ASSERT(i < m_size);
+    return m_slots[(m_head + i) & m_mask];
+  }
+
+  /**
+   * \brief Remove all elements, keeping the capacity
+   */
+  void Clear(void)
+  {
+    while (m_size > 0)
+    {
+      Pop();
+    }
+    m_head = 0;
+  }
+
+  /**
+   * \return The number of stored elements
+   */
+  uint32_t GetSize(void) const
+  {
+    return m_size;
+  }
+
+  /**
+   * \return The number of elements that fit without reallocating
+   */
+  uint32_t GetCapacity(void) const
+  {
+    return m_slots.size();
+  }
+
+  /**
+   * \return True if no element is stored
+   */
+  bool IsEmpty(void) const
+  {
+    return m_size == 0;
+  }
+
+private:
+  std::vector<T> m_slots; //!< the circular array, power-of-two sized
+  uint32_t m_head;        //!< slot of the head element
+  uint32_t m_size;        //!< number of stored elements
+  uint32_t m_mask;        //!< m_slots.size() - 1
+};
+
+}
+
+#endif
@@ -1,5 +1,4 @@
 #include "source-ip-address.h"
-#include "ns3/ipv4-header.h"
 #include "ns3/log.h"
 
 namespace ns3
@@ -38,27 +37,38 @@ void SourceIpAddress::DoDispose(void)
   FilterElement::DoDispose();
 }
 
-bool SourceIpAddress::Match(Ptr<Packet> p)
+bool SourceIpAddress::Match(const FlowKey& key) const
 {
-  NS_LOG_FUNCTION(this << p);
+  NS_LOG_FUNCTION(this << key);
 
-  Ptr<Packet> copy = p->Copy();
-
-  Ipv4Header ipHeader;
-  if (copy->PeekHeader(ipHeader))
+  if (key.flags & FlowKey::IPV4)
   {
-    NS_LOG_LOGIC("Found IPv4 header, source IP = " << ipHeader.GetSource());
-    return ipHeader.GetSource() == m_address;
+    NS_LOG_LOGIC("Found IPv4 header, source IP = " << Ipv4Address(key.source));
+    return key.source == m_address.Get();
   }
 
   NS_LOG_LOGIC("No IPv4 header found");
   return false;
 }
 
+bool SourceIpAddress::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  FlowPattern pattern = FlowPattern::Any();
+  pattern.value.source = m_address.Get();
+  pattern.mask.source = 0xffffffff;
+  pattern.value.flags = FlowKey::IPV4;
+  pattern.mask.flags = FlowKey::IPV4;
+  patterns.push_back(pattern);
+  return true;
+}
+
 void SourceIpAddress::SetAddress(Ipv4Address addr)
 {
   NS_LOG_FUNCTION(this << addr);
   m_address = addr;
+  NotifyRulesChanged();
 }
 
 Ipv4Address SourceIpAddress::GetAddress(void) const
@@ -37,10 +37,17 @@ public:
 
   /**
    * \brief Check if a packet matches this filter element
-   * \param p The packet to check
+   * \param key The classification key parsed from the packet
    * \return True if the packet matches this filter element
    */
-  virtual bool Match(Ptr<Packet> p);
+  virtual bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe this element as an exact match on the source address
+   * \param patterns Output: the patterns
+   * \return Always true
+   */
+  virtual bool GetPatterns(std::vector<FlowPattern>& patterns) const;
 
   /**
    * \brief Set the source IP address to match
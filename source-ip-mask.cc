@@ -0,0 +1,99 @@
+#include "source-ip-mask.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SourceIpMask");
+NS_OBJECT_ENSURE_REGISTERED(SourceIpMask);
+
+TypeId SourceIpMask::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::SourceIpMask")
+                          .SetParent<FilterElement>()
+                          .SetGroupName("Network")
+                          .AddConstructor<SourceIpMask>();
+  return tid;
+}
+
+SourceIpMask::SourceIpMask()
+    : m_address(Ipv4Address::GetAny()), m_mask(Ipv4Mask::GetZero())
+{
+  NS_LOG_FUNCTION(this);
+}
+
+SourceIpMask::SourceIpMask(Ipv4Address addr, Ipv4Mask mask)
+    : m_address(addr), m_mask(mask)
+{
+  NS_LOG_FUNCTION(this << addr << mask);
+}
+
+SourceIpMask::~SourceIpMask()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void SourceIpMask::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  FilterElement::DoDispose();
+}
+
+bool SourceIpMask::Match(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (key.flags & FlowKey::IPV4)
+  {
+    bool match = ((key.source ^ m_address.Get()) & m_mask.Get()) == 0;
+    NS_LOG_LOGIC("Source IP address "
+                 << Ipv4Address(key.source) << " "
+                 << (match ? "matches" : "doesn't match") << " prefix "
+                 << m_address << "/" << m_mask.GetPrefixLength());
+    return match;
+  }
+
+  NS_LOG_LOGIC("Packet doesn't have an IPv4 header");
+  return false;
+}
+
+bool SourceIpMask::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  FlowPattern pattern = FlowPattern::Any();
+  pattern.value.source = m_address.Get() & m_mask.Get();
+  pattern.mask.source = m_mask.Get();
+  pattern.value.flags = FlowKey::IPV4;
+  pattern.mask.flags = FlowKey::IPV4;
+  patterns.push_back(pattern);
+  return true;
+}
+
+void SourceIpMask::SetAddress(Ipv4Address addr)
+{
+  NS_LOG_FUNCTION(this << addr);
+  m_address = addr;
+  NotifyRulesChanged();
+}
+
+Ipv4Address SourceIpMask::GetAddress(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_address;
+}
+
+void SourceIpMask::SetMask(Ipv4Mask mask)
+{
+  NS_LOG_FUNCTION(this << mask);
+  m_mask = mask;
+  NotifyRulesChanged();
+}
+
+Ipv4Mask SourceIpMask::GetMask(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_mask;
+}
+
+}
@@ -0,0 +1,89 @@
+#ifndef SOURCE_IP_MASK_H
+#define SOURCE_IP_MASK_H
+
+#include "filter-element.h"
+#include "ns3/ipv4-address.h"
+
+namespace ns3
+{
+
+/**
+ * \brief Filter element for a source IP prefix (address and mask)
+ */
+class SourceIpMask : public FilterElement
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Default constructor, matches every IPv4 packet
+   */
+  SourceIpMask();
+
+  /**
+   * \brief Constructor with prefix
+   * \param addr The source network address to match
+   * \param mask The network mask applied to the source address
+   */
+  SourceIpMask(Ipv4Address addr, Ipv4Mask mask);
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~SourceIpMask();
+
+  /**
+   * \brief Check if a packet matches this filter element
+   * \param key The classification key parsed from the packet
+   * \return True if the masked source address equals the masked address
+   */
+  virtual bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe this element as a masked match on the source address
+   * \param patterns Output: the patterns
+   * \return Always true
+   */
+  virtual bool GetPatterns(std::vector<FlowPattern>& patterns) const;
+
+  /**
+   * \brief Set the source network address to match
+   * \param addr The network address
+   */
+  void SetAddress(Ipv4Address addr);
+
+  /**
+   * \brief Get the source network address to match
+   * \return The network address
+   */
+  Ipv4Address GetAddress(void) const;
+
+  /**
+   * \brief Set the network mask
+   * \param mask The network mask
+   */
+  void SetMask(Ipv4Mask mask);
+
+  /**
+   * \brief Get the network mask
+   * \return The network mask
+   */
+  Ipv4Mask GetMask(void) const;
+
+private:
+  Ipv4Address m_address; //!< The source network address to match
+  Ipv4Mask m_mask;       //!< The mask applied before comparing
+
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose(void);
+};
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "source-port-range.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SourcePortRange");
+NS_OBJECT_ENSURE_REGISTERED(SourcePortRange);
+
+TypeId SourcePortRange::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::SourcePortRange")
+                          .SetParent<FilterElement>()
+                          .SetGroupName("Network")
+                          .AddConstructor<SourcePortRange>();
+  return tid;
+}
+
+SourcePortRange::SourcePortRange() : m_ports()
+{
+  NS_LOG_FUNCTION(this);
+  m_ports.AddRange(0, 65535);
+}
+
+SourcePortRange::SourcePortRange(uint16_t first, uint16_t last) : m_ports()
+{
+  NS_LOG_FUNCTION(this << first << last);
+  m_ports.AddRange(first, last);
+}
+
+SourcePortRange::~SourcePortRange()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void SourcePortRange::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  FilterElement::DoDispose();
+}
+
+bool SourcePortRange::Match(const FlowKey& key) const
+{
+  NS_LOG_FUNCTION(this << key);
+
+  if (!(key.flags & FlowKey::PORTS))
+  {
+    NS_LOG_LOGIC("Packet doesn't have TCP or UDP ports");
+    return false;
+  }
+
+  bool match = m_ports.Contains(key.sourcePort);
+  NS_LOG_LOGIC("Source port " << key.sourcePort << " "
+                              << (match ? "matches" : "doesn't match"));
+  return match;
+}
+
+bool SourcePortRange::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  std::vector<uint16_t> values;
+  std::vector<uint16_t> masks;
+  m_ports.GetBlocks(values, masks);
+
+  for (uint32_t i = 0; i < values.size(); i++)
+  {
+    FlowPattern pattern = FlowPattern::Any();
+    pattern.value.sourcePort = values[i];
+    pattern.mask.sourcePort = masks[i];
+    pattern.value.flags = FlowKey::PORTS;
+    pattern.mask.flags = FlowKey::PORTS;
+    patterns.push_back(pattern);
+  }
+  return true;
+}
+
+void SourcePortRange::AddRange(uint16_t first, uint16_t last)
+{
+  NS_LOG_FUNCTION(this << first << last);
+  m_ports.AddRange(first, last);
+  NotifyRulesChanged();
+}
+
+void SourcePortRange::ClearRanges(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_ports.Clear();
+  NotifyRulesChanged();
+}
+
+}
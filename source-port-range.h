@@ -0,0 +1,77 @@
+#ifndef SOURCE_PORT_RANGE_H
+#define SOURCE_PORT_RANGE_H
+
+#include "filter-element.h"
+#include "port-bitmap.h"
+
+namespace ns3
+{
+
+/**
+ * \brief Filter element for ranges of TCP or UDP source ports
+ */
+class SourcePortRange : public FilterElement
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Default constructor, matches every source port
+   */
+  SourcePortRange();
+
+  /**
+   * \brief Constructor with a single range
+   * \param first The first source port of the range
+   * \param last The last source port of the range
+   */
+  SourcePortRange(uint16_t first, uint16_t last);
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~SourcePortRange();
+
+  /**
+   * \brief Check if a packet matches this filter element
+   * \param key The classification key parsed from the packet
+   * \return True if the packet is TCP or UDP and its source port is in
+   *         one of the ranges
+   */
+  virtual bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe the ranges as aligned blocks of source ports
+   * \param patterns Output: the patterns
+   * \return Always true
+   */
+  virtual bool GetPatterns(std::vector<FlowPattern>& patterns) const;
+
+  /**
+   * \brief Add a range of source ports to match
+   * \param first The first port of the range
+   * \param last The last port of the range
+   */
+  void AddRange(uint16_t first, uint16_t last);
+
+  /**
+   * \brief Remove all ranges; the element then matches no packet
+   */
+  void ClearRanges(void);
+
+private:
+  PortBitmap m_ports; //!< The source ports to match
+
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose(void);
+};
+
+}
+
+#endif
@@ -1,10 +1,11 @@
 #include "spq.h"
+#include "class-aqm.h"
 #include "cisco-parser.h"
 #include "ns3/log.h"
 #include "ns3/string.h"
 #include "traffic-class.h"
+#include <algorithm>
 #include <fstream>
-#include <limits>
 #include <sstream>
 
 namespace ns3
@@ -22,7 +23,25 @@ TypeId SPQ::GetTypeId(void)
   return tid;
 }
 
-SPQ::SPQ() : DiffServ(), m_configFile(""), m_ciscoConfigFile("")
+namespace
+{
+
+/// Orders class indices by priority level, lowest level first
+struct PriorityLess
+{
+  const std::vector<Ptr<TrafficClass>>& classes;
+
+  bool operator()(uint32_t a, uint32_t b) const
+  {
+    return classes[a]->GetPriorityLevel() < classes[b]->GetPriorityLevel();
+  }
+};
+
+}
+
+SPQ::SPQ()
+    : DiffServ(), m_configFile(""), m_ciscoConfigFile(""), m_rankToClass(),
+      m_classToRank(), m_backlogged(), m_rankGeneration(0)
 {
   NS_LOG_FUNCTION(this);
 }
@@ -50,33 +69,83 @@ std::string SPQ::GetCiscoConfigFile(void) const
   return m_ciscoConfigFile;
 }
 
-Ptr<Packet> SPQ::Schedule(void)
+void SPQ::RefreshRanks(void)
 {
-  NS_LOG_FUNCTION(this);
+  if (m_classToRank.size() == m_classes.size() &&
+      m_rankGeneration == GetSchedulingGeneration())
+  {
+    return;
+  }
 
-  uint32_t highestPriority = std::numeric_limits<uint32_t>::max();
-  int32_t selectedIndex = -1;
+  NS_LOG_FUNCTION(this);
+  uint32_t nClasses = m_classes.size();
 
-  for (uint32_t i = 0; i < GetNTrafficClasses(); i++)
+  m_rankToClass.resize(nClasses);
+  for (uint32_t i = 0; i < nClasses; i++)
   {
-    Ptr<TrafficClass> tClass = GetTrafficClass(i);
+    m_rankToClass[i] = i;
+  }
+  PriorityLess less = {m_classes};
+  std::stable_sort(m_rankToClass.begin(), m_rankToClass.end(), less);
 
-    if (!tClass->IsEmpty())
+  m_classToRank.resize(nClasses);
+  m_backlogged.assign((nClasses + 63) / 64, 0);
+  for (uint32_t rank = 0; rank < nClasses; rank++)
+  {
+    uint32_t classIndex = m_rankToClass[rank];
+    m_classToRank[classIndex] = rank;
+    if (!m_classes[classIndex]->IsEmpty())
     {
-      uint32_t priority = tClass->GetPriorityLevel();
-      if (priority < highestPriority)
-      {
-        highestPriority = priority;
-        selectedIndex = i;
-      }
+      m_backlogged[rank / 64] |= uint64_t(1) << (rank % 64);
     }
   }
 
-  if (selectedIndex >= 0)
+  m_rankGeneration = GetSchedulingGeneration();
+}
+
+void SPQ::NotifyEnqueue(uint32_t classIndex, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << classIndex << p);
+  RefreshRanks();
+  uint32_t rank = m_classToRank[classIndex];
+  m_backlogged[rank / 64] |= uint64_t(1) << (rank % 64);
+}
+
+Ptr<Packet> SPQ::Schedule(void)
+{
+  NS_LOG_FUNCTION(this);
+  RefreshRanks();
+
+  for (uint32_t word = 0; word < m_backlogged.size(); word++)
   {
-    NS_LOG_LOGIC("Serving traffic class " << selectedIndex << " with priority "
-                                          << highestPriority);
-    return GetTrafficClass(selectedIndex)->Dequeue();
+    uint64_t candidates = m_backlogged[word];
+    while (candidates)
+    {
+      uint32_t bit = __builtin_ctzll(candidates);
+      uint64_t mask = uint64_t(1) << bit;
+      candidates &= ~mask;
+      uint32_t rank = word * 64 + bit;
+      uint32_t classIndex = m_rankToClass[rank];
+      const Ptr<TrafficClass>& tClass = m_classes[classIndex];
+
+      if (!tClass->IsEmpty() && !CanServe(classIndex))
+      {
+        NS_LOG_LOGIC("Traffic class " << classIndex << " held by its shaper");
+        continue;
+      }
+      Ptr<Packet> p = tClass->Dequeue();
+      if (tClass->IsEmpty())
+      {
+        m_backlogged[word] &= ~mask;
+      }
+      if (p)
+      {
+        NS_LOG_LOGIC("Serving traffic class "
+                     << classIndex << " with priority "
+                     << tClass->GetPriorityLevel());
+        return p;
+      }
+    }
   }
 
   NS_LOG_LOGIC("No packet found in scheduling");
@@ -126,6 +195,20 @@ bool SPQ::SetConfigFile(std::string filename)
       Ptr<TrafficClass> tClass = CreateObject<TrafficClass>();
       tClass->SetPriorityLevel(priority);
 
+      // Optional AQM name after the priority level
+      std::string aqmName;
+      if (iss >> aqmName)
+      {
+        Ptr<ClassAqm> aqm;
+        if (!ClassAqm::CreateFromName(aqmName, aqm))
+        {
+          NS_LOG_ERROR("Invalid AQM " << aqmName << " for queue " << i);
+          file.close();
+          return false;
+        }
+        tClass->SetAqm(aqm);
+      }
+
       AddTrafficClass(tClass);
 
       NS_LOG_INFO("Added traffic class " << i << " with priority " << priority);
@@ -158,17 +241,21 @@ bool SPQ::SetCiscoConfigFile(std::string filename)
     return false;
   }
 
+  std::vector<Ptr<TrafficClass>> classes;
   for (uint32_t i = 0; i < numQueues; i++)
   {
     Ptr<TrafficClass> tClass = CreateObject<TrafficClass>();
     tClass->SetPriorityLevel(priorities[i]);
 
     AddTrafficClass(tClass);
+    classes.push_back(tClass);
 
     NS_LOG_INFO("Added traffic class " << i << " with priority "
                                        << priorities[i]);
   }
 
+  parser->AddDscpFilters(classes);
+
   return true;
 }
 
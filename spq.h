@@ -3,6 +3,7 @@
 
 #include "diffserv.h"
 #include <string>
+#include <vector>
 
 namespace ns3
 {
@@ -10,6 +11,12 @@ namespace ns3
 /**
  * \ingroup queue
  * \brief A Strict Priority Queueing (SPQ) implementation
+ *
+ * Traffic classes are ranked by priority level once, whenever the set of
+ * classes or their priorities change.  A bitmap with one bit per rank
+ * tracks the backlogged classes, so that Schedule finds the highest
+ * priority non-empty class with a find-first-set per 64 classes instead
+ * of scanning every class.  Equal priorities keep insertion order.
  */
 class SPQ : public DiffServ
 {
@@ -68,9 +75,26 @@ protected:
    */
   virtual void DoDispose(void) override;
 
+  /**
+   * \brief Mark the rank of a traffic class as backlogged
+   * \param classIndex The index of the traffic class
+   * \param p The enqueued packet
+   */
+  virtual void NotifyEnqueue(uint32_t classIndex,
+                             Ptr<const Packet> p) override;
+
 private:
+  /**
+   * \brief Recompute the ranks if classes or priorities have changed
+   */
+  void RefreshRanks(void);
+
   std::string m_configFile;
   std::string m_ciscoConfigFile;
+  std::vector<uint32_t> m_rankToClass; //!< class index by priority rank
+  std::vector<uint32_t> m_classToRank; //!< priority rank by class index
+  std::vector<uint64_t> m_backlogged;  //!< bit per rank of non-empty classes
+  uint64_t m_rankGeneration;           //!< scheduling generation of the ranks
 };
 
 }
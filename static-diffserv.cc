@@ -0,0 +1,160 @@
+#include "static-diffserv.h"
+#include "ns3/log.h"
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("StaticDiffServ");
+NS_OBJECT_ENSURE_REGISTERED(StaticSPQ);
+NS_OBJECT_ENSURE_REGISTERED(StaticDRR);
+
+namespace
+{
+
+/**
+ * \brief Read a configuration file of one number per class
+ *
+ * The first line holds the number of classes, each following line the
+ * number of one class (a priority or a quantum).  Anything after it, such
+ * as an AQM name, is refused.
+ *
+ * \param filename The file
+ * \param values Receives the number of each class
+ * \return True if successful
+ */
+bool ReadClassValues(const std::string& filename,
+                     std::vector<uint32_t>& values)
+{
+  std::ifstream file(filename.c_str());
+  if (!file.is_open())
+  {
+    NS_LOG_ERROR("Failed to open file " << filename);
+    return false;
+  }
+
+  std::string line;
+  uint32_t numQueues = 0;
+  if (!std::getline(file, line) || !(std::istringstream(line) >> numQueues) ||
+      numQueues == 0)
+  {
+    NS_LOG_ERROR("Invalid number of queues");
+    return false;
+  }
+
+  values.clear();
+  for (uint32_t i = 0; i < numQueues; i++)
+  {
+    uint32_t value;
+    std::string extra;
+    if (!std::getline(file, line))
+    {
+      NS_LOG_ERROR("Not enough queues specified");
+      return false;
+    }
+    std::istringstream iss(line);
+    if (!(iss >> value))
+    {
+      NS_LOG_ERROR("Invalid value for queue " << i);
+      return false;
+    }
+    if (iss >> extra)
+    {
+      NS_LOG_ERROR("Unsupported option " << extra << " for queue " << i);
+      return false;
+    }
+    values.push_back(value);
+  }
+  return true;
+}
+
+}
+
+TypeId StaticSPQ::GetTypeId(void)
+{
+  static TypeId tid = MakeTypeId<StaticSPQ>("ns3::StaticSPQ");
+  return tid;
+}
+
+StaticSPQ::StaticSPQ()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+StaticSPQ::~StaticSPQ()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+bool StaticSPQ::SetConfigFile(std::string filename)
+{
+  NS_LOG_FUNCTION(this << filename);
+
+  std::vector<uint32_t> priorities;
+  if (!ReadClassValues(filename, priorities))
+  {
+    return false;
+  }
+  if (priorities.size() > StrictPriorityScheduler::MAX_CLASSES)
+  {
+    NS_LOG_ERROR("At most " << StrictPriorityScheduler::MAX_CLASSES
+                            << " queues are supported");
+    return false;
+  }
+
+  m_core.SetNClasses(priorities.size(),
+                     m_core.GetBufferPolicy().GetMaxPackets());
+  for (uint32_t i = 0; i < priorities.size(); i++)
+  {
+    m_core.GetScheduler().SetPriority(i, priorities[i]);
+    NS_LOG_INFO("Added class " << i << " with priority " << priorities[i]);
+  }
+  return true;
+}
+
+TypeId StaticDRR::GetTypeId(void)
+{
+  static TypeId tid = MakeTypeId<StaticDRR>("ns3::StaticDRR");
+  return tid;
+}
+
+StaticDRR::StaticDRR()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+StaticDRR::~StaticDRR()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+bool StaticDRR::SetConfigFile(std::string filename)
+{
+  NS_LOG_FUNCTION(this << filename);
+
+  std::vector<uint32_t> quanta;
+  if (!ReadClassValues(filename, quanta))
+  {
+    return false;
+  }
+  for (uint32_t i = 0; i < quanta.size(); i++)
+  {
+    if (quanta[i] == 0)
+    {
+      NS_LOG_ERROR("Invalid quantum 0 for queue " << i);
+      return false;
+    }
+  }
+
+  m_core.SetNClasses(quanta.size(), m_core.GetBufferPolicy().GetMaxPackets());
+  for (uint32_t i = 0; i < quanta.size(); i++)
+  {
+    m_core.GetScheduler().SetQuantum(i, quanta[i]);
+    NS_LOG_INFO("Added class " << i << " with quantum " << quanta[i]);
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,238 @@
+#ifndef STATIC_DIFFSERV_H
+#define STATIC_DIFFSERV_H
+
+#include "diffserv-core.h"
+#include "diffserv-policies.h"
+#include "flow-key.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+#include "ns3/uinteger.h"
+#include <iterator>
+#include <string>
+
+namespace ns3
+{
+
+/**
+ * \ingroup queue
+ * \brief A Queue<Packet> running a DiffServCore
+ *
+ * Packets are stored in the Queue<Packet> base, which keeps MaxSize, the
+ * QueueBase statistics and the traces accurate, and the core keeps the
+ * base queue iterators of each class.  Classification parses each packet
+ * once into a FlowKey and involves no virtual call.
+ *
+ * Unlike the dynamic DiffServ queue, the classes are not TrafficClass
+ * objects: there are no per-class AQM, ECN, rate control or runtime filter
+ * changes.  Setups needing those use SPQ, DRR and the other DiffServ
+ * subclasses.
+ *
+ * Until the classes are created, every arrival is dropped.
+ *
+ * \tparam Classifier The classifier policy
+ * \tparam Scheduler The scheduler policy
+ * \tparam BufferPolicy The admission policy of the classes
+ */
+template <typename Classifier, typename Scheduler, typename BufferPolicy>
+class StaticDiffServ : public Queue<Packet>
+{
+public:
+  /// The core, storing base queue iterators
+  typedef DiffServCore<Classifier, Scheduler, BufferPolicy, ConstIterator>
+      Core;
+
+  virtual bool Enqueue(Ptr<Packet> p) override
+  {
+    if (m_core.GetNClasses() == 0)
+    {
+      DropBeforeEnqueue(p);
+      return false;
+    }
+    FlowKey key = FlowKey::Parse(p);
+    uint32_t classIndex = m_core.Classify(key);
+    if (!m_core.Admit(classIndex, key.size))
+    {
+      DropBeforeEnqueue(p);
+      return false;
+    }
+    // The base queue drops the packet itself when MaxSize is reached
+    if (!Queue<Packet>::DoEnqueue(GetContainer().end(), p))
+    {
+      return false;
+    }
+    m_core.Push(classIndex, std::prev(GetContainer().end()), key.size);
+    return true;
+  }
+
+  virtual Ptr<Packet> Dequeue(void) override
+  {
+    ConstIterator pos;
+    if (!m_core.Pop(pos))
+    {
+      return 0;
+    }
+    return Queue<Packet>::DoDequeue(pos);
+  }
+
+  virtual Ptr<Packet> Remove(void) override
+  {
+    ConstIterator pos;
+    if (!m_core.Pop(pos))
+    {
+      return 0;
+    }
+    return Queue<Packet>::DoRemove(pos);
+  }
+
+  virtual Ptr<const Packet> Peek(void) const override
+  {
+    // Selecting only advances the scheduler to the decision that Dequeue
+    // takes anyway, as FlowQueueSet::Front does
+    ConstIterator pos;
+    if (!const_cast<Core&>(m_core).Peek(pos))
+    {
+      return 0;
+    }
+    return *pos;
+  }
+
+  /**
+   * \return The number of classes
+   */
+  uint32_t GetNClasses(void) const
+  {
+    return m_core.GetNClasses();
+  }
+
+  /**
+   * \brief Send packets for a destination port to a class
+   *
+   * Only available with a Classifier mapping ports, such as
+   * DestPortClassifier.
+   *
+   * \param port The TCP or UDP destination port
+   * \param classIndex The class
+   */
+  void AddPortRule(uint16_t port, uint32_t classIndex)
+  {
+    m_core.GetClassifier().Add(port, classIndex);
+  }
+
+protected:
+  /**
+   * \brief Build the TypeId of a queue running the core
+   * \tparam Derived The queue class
+   * \param name The TypeId name
+   * \return The TypeId, with the MaxSize and ClassMaxPackets attributes
+   */
+  template <typename Derived>
+  static TypeId MakeTypeId(const std::string& name)
+  {
+    return TypeId(name)
+        .SetParent<Queue<Packet>>()
+        .SetGroupName("Network")
+        .AddConstructor<Derived>()
+        .AddAttribute(
+            "MaxSize",
+            "The maximum number of packets or bytes shared by all classes.",
+            QueueSizeValue(QueueSize("100p")),
+            MakeQueueSizeAccessor(&QueueBase::SetMaxSize,
+                                  &QueueBase::GetMaxSize),
+            MakeQueueSizeChecker())
+        .AddAttribute("ClassMaxPackets",
+                      "The maximum number of packets of each class.",
+                      UintegerValue(100),
+                      MakeUintegerAccessor(&StaticDiffServ::SetClassMaxPackets,
+                                           &StaticDiffServ::GetClassMaxPackets),
+                      MakeUintegerChecker<uint32_t>());
+  }
+
+  virtual void DoDispose(void) override
+  {
+    m_core.Clear();
+    Queue<Packet>::DoDispose();
+  }
+
+  /**
+   * \brief Set the packet limit of every class
+   * \param maxPackets The limit
+   */
+  void SetClassMaxPackets(uint32_t maxPackets)
+  {
+    m_core.GetBufferPolicy().SetMaxPackets(maxPackets);
+  }
+
+  /**
+   * \return The packet limit of every class
+   */
+  uint32_t GetClassMaxPackets(void) const
+  {
+    return m_core.GetBufferPolicy().GetMaxPackets();
+  }
+
+  Core m_core; //!< classes, classifier and scheduler
+};
+
+/**
+ * \ingroup queue
+ * \brief Strict priority queueing on a compile-time specialized core
+ *
+ * Classes are selected by destination port and served by priority, lower
+ * values first, as by SPQ.  SetConfigFile reads the spq.config format;
+ * AQM names are not supported.
+ */
+class StaticSPQ
+    : public StaticDiffServ<DestPortClassifier, StrictPriorityScheduler,
+                            TailDropBuffer>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  StaticSPQ();
+  virtual ~StaticSPQ();
+
+  /**
+   * \brief Create the classes listed in a configuration file
+   * \param filename The file, in the spq.config format
+   * \return True if successful
+   */
+  bool SetConfigFile(std::string filename);
+};
+
+/**
+ * \ingroup queue
+ * \brief Deficit round robin on a compile-time specialized core
+ *
+ * Classes are selected by destination port and share the link in
+ * proportion to their quanta, as by DRR.  SetConfigFile reads the
+ * drr.config format; AQM names are not supported.
+ */
+class StaticDRR
+    : public StaticDiffServ<DestPortClassifier, DeficitRoundRobinScheduler,
+                            TailDropBuffer>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  StaticDRR();
+  virtual ~StaticDRR();
+
+  /**
+   * \brief Create the classes listed in a configuration file
+   * \param filename The file, in the drr.config format
+   * \return True if successful
+   */
+  bool SetConfigFile(std::string filename);
+};
+
+}
+
+#endif
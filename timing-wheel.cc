@@ -0,0 +1,179 @@
+#include "timing-wheel.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TimingWheel");
+
+TimingWheel::TimingWheel()
+    : m_overflow(), m_due(), m_granularity(MicroSeconds(1).GetTimeStep()),
+      m_now(0), m_nEntries(0)
+{
+  for (uint32_t level = 0; level < LEVELS; level++)
+  {
+    m_occupied[level] = 0;
+  }
+}
+
+void TimingWheel::SetGranularity(Time granularity)
+{
+  NS_LOG_FUNCTION(this << granularity);
+  NS_ASSERT_MSG(IsEmpty(), "Cannot change the granularity of a busy wheel");
+  NS_ASSERT(granularity.IsStrictlyPositive());
+  // Keep the current position in the new unit
+  m_now = m_now * m_granularity / granularity.GetTimeStep();
+  m_granularity = granularity.GetTimeStep();
+}
+
+Time TimingWheel::GetGranularity(void) const
+{
+  return TimeStep(m_granularity);
+}
+
+void TimingWheel::Insert(uint32_t id, Time when)
+{
+  NS_LOG_FUNCTION(this << id << when);
+
+  int64_t ts = when.GetTimeStep();
+  Entry entry;
+  entry.tick = (ts <= 0) ? 0 : (ts + m_granularity - 1) / m_granularity;
+  entry.id = id;
+  m_nEntries++;
+  Place(entry, m_due);
+}
+
+void TimingWheel::Place(const Entry& entry, std::vector<uint32_t>& released)
+{
+  if (entry.tick <= m_now)
+  {
+    m_nEntries--;
+    released.push_back(entry.id);
+    return;
+  }
+
+  uint32_t level = (63 - __builtin_clzll(entry.tick ^ m_now)) / SLOT_BITS;
+  if (level >= LEVELS)
+  {
+    m_overflow.push_back(entry);
+    return;
+  }
+  uint32_t slot = (entry.tick >> (level * SLOT_BITS)) & (SLOTS - 1);
+  m_slots[level][slot].push_back(entry);
+  m_occupied[level] |= uint64_t(1) << slot;
+}
+
+void TimingWheel::Cascade(uint32_t level, uint32_t slot,
+                          std::vector<uint32_t>& released)
+{
+  std::vector<Entry> entries;
+  entries.swap(m_slots[level][slot]);
+  m_occupied[level] &= ~(uint64_t(1) << slot);
+  for (uint32_t i = 0; i < entries.size(); i++)
+  {
+    Place(entries[i], released);
+  }
+}
+
+void TimingWheel::Advance(Time now, std::vector<uint32_t>& released)
+{
+  NS_LOG_FUNCTION(this << now);
+
+  if (!m_due.empty())
+  {
+    released.insert(released.end(), m_due.begin(), m_due.end());
+    m_due.clear();
+  }
+
+  int64_t ts = now.GetTimeStep();
+  uint64_t tick = (ts <= 0) ? 0 : ts / m_granularity;
+  if (tick <= m_now)
+  {
+    return;
+  }
+
+  // Digits below the highest changed one wrapped: their entries are due.
+  // At the highest changed digit, the slots up to the new position are
+  // either due or move down to finer levels.
+  uint32_t changed = (63 - __builtin_clzll(tick ^ m_now)) / SLOT_BITS;
+  m_now = tick;
+  for (uint32_t level = 0; level < LEVELS && level <= changed; level++)
+  {
+    uint64_t occupied = m_occupied[level];
+    if (level == changed)
+    {
+      uint32_t digit = (tick >> (level * SLOT_BITS)) & (SLOTS - 1);
+      occupied &= (digit == SLOTS - 1) ? ~uint64_t(0)
+                                       : (uint64_t(1) << (digit + 1)) - 1;
+    }
+    while (occupied != 0)
+    {
+      uint32_t slot = __builtin_ctzll(occupied);
+      occupied &= occupied - 1;
+      Cascade(level, slot, released);
+    }
+  }
+
+  if (changed >= LEVELS && !m_overflow.empty())
+  {
+    std::vector<Entry> entries;
+    entries.swap(m_overflow);
+    for (uint32_t i = 0; i < entries.size(); i++)
+    {
+      Place(entries[i], released);
+    }
+  }
+}
+
+Time TimingWheel::GetNextExpiry(void) const
+{
+  if (!m_due.empty())
+  {
+    return TimeStep(m_now * m_granularity);
+  }
+  for (uint32_t level = 0; level < LEVELS; level++)
+  {
+    if (m_occupied[level] != 0)
+    {
+      uint32_t shift = (level + 1) * SLOT_BITS;
+      uint64_t slot = __builtin_ctzll(m_occupied[level]);
+      uint64_t tick = ((m_now >> shift) << shift) | (slot << (level * SLOT_BITS));
+      return TimeStep(tick * m_granularity);
+    }
+  }
+  if (!m_overflow.empty())
+  {
+    uint32_t shift = LEVELS * SLOT_BITS;
+    return TimeStep((((m_now >> shift) + 1) << shift) * m_granularity);
+  }
+  return Time::Max();
+}
+
+bool TimingWheel::IsEmpty(void) const
+{
+  return m_nEntries == 0;
+}
+
+uint32_t TimingWheel::GetNEntries(void) const
+{
+  return m_nEntries;
+}
+
+void TimingWheel::Clear(void)
+{
+  NS_LOG_FUNCTION(this);
+  for (uint32_t level = 0; level < LEVELS; level++)
+  {
+    for (uint32_t slot = 0; slot < SLOTS; slot++)
+    {
+      m_slots[level][slot].clear();
+    }
+    m_occupied[level] = 0;
+  }
+  m_overflow.clear();
+  m_due.clear();
+  m_nEntries = 0;
+}
+
+}
@@ -0,0 +1,127 @@
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include "ns3/nstime.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief A hierarchical timing wheel of release times
+ *
+ * Time is cut into ticks of Granularity.  Each of the LEVELS wheels has
+ * SLOTS slots, a slot of level l spanning SLOTS^l ticks, and an entry is
+ * kept at the level of the highest base-SLOTS digit in which its release
+ * tick differs from the current tick; entries further away than the
+ * outermost wheel wait in an overflow list.  Advancing the wheel releases
+ * every entry due in one pass and moves the entries of the slot just
+ * reached down to finer levels, so the cost is proportional to the
+ * entries touched rather than to the elapsed ticks or the number of
+ * pending entries.  A bitmap per level finds the next occupied slot, whose
+ * start is when the owner needs to look at the wheel again: one timer per
+ * occupied slot at most, however many entries share it.
+ *
+ * Release times are rounded up to the next tick, so entries are never
+ * released early.  Entries cannot be removed; owners are expected to
+ * ignore the release of an entry they no longer care about.
+ */
+class TimingWheel
+{
+public:
+  static const uint32_t LEVELS = 4;    //!< number of wheels
+  static const uint32_t SLOT_BITS = 6; //!< log2 of the slots per wheel
+  static const uint32_t SLOTS = 1 << SLOT_BITS; //!< slots per wheel
+
+  TimingWheel();
+
+  /**
+   * \brief Set the tick length
+   * \param granularity The tick length; the wheel must be empty
+   */
+  void SetGranularity(Time granularity);
+
+  /**
+   * \return The tick length
+   */
+  Time GetGranularity(void) const;
+
+  /**
+   * \brief Add an entry
+   * \param id The identifier reported on release
+   * \param when The release time; a time already reached releases the
+   *        entry on the next Advance
+   */
+  void Insert(uint32_t id, Time when);
+
+  /**
+   * \brief Move the wheel forward and collect the released entries
+   * \param now The current time, not earlier than on the last call
+   * \param released Receives the identifiers of the entries now due
+   */
+  void Advance(Time now, std::vector<uint32_t>& released);
+
+  /**
+   * \brief Get when the wheel needs to be advanced next
+   *
+   * This is the start of the first occupied slot, no later than the
+   * earliest release time; advancing then may only cascade entries down
+   * without releasing any.
+   *
+   * \return The time, or Time::Max() if the wheel is empty
+   */
+  Time GetNextExpiry(void) const;
+
+  /**
+   * \return True if no entry is pending
+   */
+  bool IsEmpty(void) const;
+
+  /**
+   * \return The number of pending entries
+   */
+  uint32_t GetNEntries(void) const;
+
+  /**
+   * \brief Drop all entries
+   */
+  void Clear(void);
+
+private:
+  /// A pending release
+  struct Entry
+  {
+    uint64_t tick; //!< release tick
+    uint32_t id;   //!< identifier of the entry
+  };
+
+  /**
+   * \brief Store an entry at the level matching its distance from m_now
+   * \param entry The entry
+   * \param released Receives the entry identifier if it is already due
+   */
+  void Place(const Entry& entry, std::vector<uint32_t>& released);
+
+  /**
+   * \brief Take the entries of a slot and place them again
+   * \param level The level
+   * \param slot The slot
+   * \param released Receives the identifiers of the entries now due
+   */
+  void Cascade(uint32_t level, uint32_t slot,
+               std::vector<uint32_t>& released);
+
+  std::vector<Entry> m_slots[LEVELS][SLOTS]; //!< entries by level and slot
+  uint64_t m_occupied[LEVELS];               //!< non-empty slots per level
+  std::vector<Entry> m_overflow;             //!< beyond the outer wheel
+  std::vector<uint32_t> m_due;               //!< inserted already due
+  int64_t m_granularity;                     //!< tick length in time steps
+  uint64_t m_now;                            //!< current tick
+  uint32_t m_nEntries;                       //!< pending entries
+};
+
+}
+
+#endif
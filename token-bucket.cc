@@ -0,0 +1,80 @@
+#include "token-bucket.h"
+#include "ns3/log.h"
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("TokenBucket");
+
+TokenBucket::TokenBucket()
+    : m_rate(0), m_burst(0), m_tokens(0), m_last(Time(0))
+{
+}
+
+void TokenBucket::SetRate(DataRate rate, uint32_t burst)
+{
+  NS_LOG_FUNCTION(this << rate << burst);
+  m_rate = rate.GetBitRate();
+  m_burst = burst;
+  m_tokens = burst;
+}
+
+DataRate TokenBucket::GetRate(void) const
+{
+  return DataRate(m_rate);
+}
+
+uint32_t TokenBucket::GetBurst(void) const
+{
+  return m_burst;
+}
+
+void TokenBucket::Refill(Time now)
+{
+  if (now > m_last)
+  {
+    m_tokens += (now - m_last).GetSeconds() * m_rate / 8.0;
+    if (m_tokens > m_burst)
+    {
+      m_tokens = m_burst;
+    }
+  }
+  m_last = now;
+}
+
+double TokenBucket::GetTokens(Time now)
+{
+  Refill(now);
+  return m_tokens;
+}
+
+bool TokenBucket::Conforms(Time now, uint32_t bytes)
+{
+  Refill(now);
+  return m_tokens >= ((bytes < m_burst) ? bytes : m_burst);
+}
+
+void TokenBucket::Consume(Time now, uint32_t bytes)
+{
+  Refill(now);
+  m_tokens -= bytes;
+}
+
+Time TokenBucket::GetDelay(Time now, uint32_t bytes)
+{
+  Refill(now);
+  if (bytes > m_burst)
+  {
+    bytes = m_burst;
+  }
+  if (m_tokens >= bytes || m_rate == 0)
+  {
+    return Time(0);
+  }
+  // Round up so that the bucket conforms when the delay has elapsed
+  double seconds = (bytes - m_tokens) * 8.0 / m_rate;
+  return NanoSeconds(static_cast<int64_t>(std::ceil(seconds * 1e9)) + 1);
+}
+
+}
@@ -0,0 +1,97 @@
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup diffserv
+ * \brief A byte token bucket refilled lazily
+ *
+ * Tokens are not added by periodic events: every query first credits the
+ * tokens earned since the last one, at the configured rate and capped at
+ * the burst size.  Consuming may drive the bucket negative, so that a
+ * packet larger than the remaining tokens is paid for by the following
+ * ones.  A packet larger than the bucket conforms once the bucket is full.
+ * A bucket with a zero rate is disabled.
+ */
+class TokenBucket
+{
+public:
+  TokenBucket();
+
+  /**
+   * \brief Configure the bucket and fill it
+   * \param rate The token rate; 0 disables the bucket
+   * \param burst The bucket size in bytes
+   */
+  void SetRate(DataRate rate, uint32_t burst);
+
+  /**
+   * \return The token rate
+   */
+  DataRate GetRate(void) const;
+
+  /**
+   * \return The bucket size in bytes
+   */
+  uint32_t GetBurst(void) const;
+
+  /**
+   * \return True if the bucket has a non-zero rate
+   */
+  bool IsEnabled(void) const
+  {
+    return m_rate != 0;
+  }
+
+  /**
+   * \brief Get the tokens available at a given time
+   * \param now The current time, not earlier than the last query
+   * \return The tokens in bytes, negative while in debt
+   */
+  double GetTokens(Time now);
+
+  /**
+   * \brief Check whether a packet is in profile
+   * \param now The current time
+   * \param bytes The packet size
+   * \return True if the bucket holds at least that many tokens
+   */
+  bool Conforms(Time now, uint32_t bytes);
+
+  /**
+   * \brief Remove tokens, possibly going into debt
+   * \param now The current time
+   * \param bytes The number of tokens to remove
+   */
+  void Consume(Time now, uint32_t bytes);
+
+  /**
+   * \brief Get the time until a packet would be in profile
+   * \param now The current time
+   * \param bytes The packet size
+   * \return The delay, zero if the packet already conforms
+   */
+  Time GetDelay(Time now, uint32_t bytes);
+
+private:
+  /**
+   * \brief Credit the tokens earned since the last update
+   * \param now The current time
+   */
+  void Refill(Time now);
+
+  uint64_t m_rate;   //!< token rate in bit/s
+  uint32_t m_burst;  //!< bucket size in bytes
+  double m_tokens;   //!< tokens in bytes at m_last
+  Time m_last;       //!< time of the last refill
+};
+
+}
+
+#endif
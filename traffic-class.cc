@@ -1,8 +1,16 @@
 #include "traffic-class.h"
+#include "compiled-classifier.h"
+#include "ecn-marker.h"
 #include "filter.h"
+#include "ns3/assert.h"
+#include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/enum.h"
+#include "ns3/ipv4-header.h"
 #include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/simulator.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 
 namespace ns3
@@ -20,27 +28,173 @@ TypeId TrafficClass::GetTypeId(void)
           .AddConstructor<TrafficClass>()
           .AddAttribute(
               "Weight", "The weight of this traffic class (for WFQ, DRR, etc.)",
-              DoubleValue(1.0), MakeDoubleAccessor(&TrafficClass::m_weight),
+              DoubleValue(1.0),
+              MakeDoubleAccessor(&TrafficClass::SetWeight,
+                                 &TrafficClass::GetWeight),
               MakeDoubleChecker<double>(0.0))
+          .AddAttribute("Alpha",
+                        "The dynamic threshold factor of this traffic class: "
+                        "it may use up to Alpha times the free shared buffer "
+                        "(with DiffServ DynamicThresholds)",
+                        DoubleValue(1.0),
+                        MakeDoubleAccessor(&TrafficClass::m_alpha),
+                        MakeDoubleChecker<double>(0.0))
           .AddAttribute("PriorityLevel",
                         "The priority level of this traffic class (for SPQ)",
                         UintegerValue(0),
-                        MakeUintegerAccessor(&TrafficClass::m_priorityLevel),
+                        MakeUintegerAccessor(&TrafficClass::SetPriorityLevel,
+                                             &TrafficClass::GetPriorityLevel),
                         MakeUintegerChecker<uint32_t>())
           .AddAttribute(
               "MaxPackets",
               "The maximum number of packets allowed in this traffic class",
               UintegerValue(100),
-              MakeUintegerAccessor(&TrafficClass::m_maxPackets),
-              MakeUintegerChecker<uint32_t>());
+              MakeUintegerAccessor(&TrafficClass::SetMaxPackets,
+                                   &TrafficClass::GetMaxPackets),
+              MakeUintegerChecker<uint32_t>())
+          .AddAttribute("MaxBytes",
+                        "The maximum number of bytes allowed in this traffic "
+                        "class (0 means no byte limit)",
+                        UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::m_maxBytes),
+                        MakeUintegerChecker<uint32_t>())
+          .AddAttribute("Aqm",
+                        "The active queue management of this traffic class "
+                        "(none: tail drop only)",
+                        PointerValue(),
+                        MakePointerAccessor(&TrafficClass::SetAqm,
+                                            &TrafficClass::GetAqm),
+                        MakePointerChecker<ClassAqm>())
+          .AddAttribute("FlowQueues",
+                        "The number of per-flow sub-queues served by DRR "
+                        "inside this traffic class (0: a single FIFO)",
+                        UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::SetFlowQueues,
+                                             &TrafficClass::GetFlowQueues),
+                        MakeUintegerChecker<uint32_t>())
+          .AddAttribute("FlowQuantum",
+                        "The DRR quantum in bytes of the per-flow sub-queues",
+                        UintegerValue(1514),
+                        MakeUintegerAccessor(&TrafficClass::SetFlowQuantum,
+                                             &TrafficClass::GetFlowQuantum),
+                        MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute("OverflowDrops",
+                        "The number of stored packets dropped from the "
+                        "fattest flow to make room for arrivals",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::GetNOverflowDrops),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("UseEcn",
+                        "Mark ECN-capable packets CE instead of dropping "
+                        "them when the AQM or the DiffServ threshold signals "
+                        "congestion",
+                        BooleanValue(false),
+                        MakeBooleanAccessor(&TrafficClass::SetUseEcn,
+                                            &TrafficClass::GetUseEcn),
+                        MakeBooleanChecker())
+          .AddAttribute("EcnMarks",
+                        "The number of packets marked CE instead of dropped",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::GetNEcnMarks),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("AqmEnqueueDrops",
+                        "The number of arrivals dropped by the AQM",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(
+                            &TrafficClass::GetNAqmEnqueueDrops),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("AqmDequeueDrops",
+                        "The number of stored packets dropped by the AQM",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(
+                            &TrafficClass::GetNAqmDequeueDrops),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("RateMode",
+                        "What the token buckets do: nothing, police arrivals "
+                        "or shape departures",
+                        EnumValue(TrafficClass::RATE_UNLIMITED),
+                        MakeEnumAccessor(&TrafficClass::SetRateMode,
+                                         &TrafficClass::GetRateMode),
+                        MakeEnumChecker(TrafficClass::RATE_UNLIMITED,
+                                        "Unlimited", TrafficClass::RATE_POLICE,
+                                        "Police", TrafficClass::RATE_SHAPE,
+                                        "Shape"))
+          .AddAttribute("Cir", "The committed information rate (0: no limit)",
+                        DataRateValue(DataRate(0)),
+                        MakeDataRateAccessor(&TrafficClass::SetCir,
+                                             &TrafficClass::GetCir),
+                        MakeDataRateChecker())
+          .AddAttribute("Cbs", "The committed burst size in bytes",
+                        UintegerValue(15000),
+                        MakeUintegerAccessor(&TrafficClass::SetCbs,
+                                             &TrafficClass::GetCbs),
+                        MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute("Pir",
+                        "The peak information rate (0: single-rate meter)",
+                        DataRateValue(DataRate(0)),
+                        MakeDataRateAccessor(&TrafficClass::SetPir,
+                                             &TrafficClass::GetPir),
+                        MakeDataRateChecker())
+          .AddAttribute("Pbs", "The peak burst size in bytes",
+                        UintegerValue(15000),
+                        MakeUintegerAccessor(&TrafficClass::SetPbs,
+                                             &TrafficClass::GetPbs),
+                        MakeUintegerChecker<uint32_t>(1))
+          .AddAttribute("ExceedAction",
+                        "What the policer does with arrivals above the "
+                        "committed rate (and below the peak rate)",
+                        EnumValue(TrafficClass::EXCEED_DROP),
+                        MakeEnumAccessor(&TrafficClass::m_exceedAction),
+                        MakeEnumChecker(TrafficClass::EXCEED_DROP, "Drop",
+                                        TrafficClass::EXCEED_REMARK, "Remark"))
+          .AddAttribute("ExceedDscp",
+                        "The DSCP given to arrivals re-marked by the policer",
+                        UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::m_exceedDscp),
+                        MakeUintegerChecker<uint8_t>(0, 63))
+          .AddAttribute("PolicerDrops",
+                        "The number of arrivals dropped by the policer",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::GetNPolicerDrops),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("PolicerRemarks",
+                        "The number of arrivals re-marked by the policer",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(
+                            &TrafficClass::GetNPolicerRemarks),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("PushOuts",
+                        "The number of stored packets dropped to make room "
+                        "for arrivals in other classes",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::GetNPushOuts),
+                        MakeUintegerChecker<uint64_t>())
+          .AddAttribute("TailDrops",
+                        "The number of arrivals refused for lack of room in "
+                        "the class or in the shared buffer",
+                        TypeId::ATTR_GET, UintegerValue(0),
+                        MakeUintegerAccessor(&TrafficClass::GetNTailDrops),
+                        MakeUintegerChecker<uint64_t>())
+          .AddTraceSource("Drop",
+                          "A packet of this class was refused or dropped "
+                          "after it was stored",
+                          MakeTraceSourceAccessor(&TrafficClass::m_traceDrop),
+                          "ns3::Packet::TracedCallback");
   return tid;
 }
 
 TrafficClass::TrafficClass()
-    : m_filters(), m_mode(0),
-      m_packets(0), m_maxPackets(100), m_weight(1.0), m_priorityLevel(0)
+    : m_filters(), m_rulesVersion(0), m_mode(0), m_maxPackets(100),
+      m_maxBytes(0), m_bytes(0), m_weight(1.0), m_alpha(1.0),
+      m_priorityLevel(0), m_queue(), m_flowQueues(), m_flowMode(false),
+      m_overflowDrops(0), m_pushOuts(0), m_tailDrops(0), m_aqm(0), m_aqmEnqueueDrops(0),
+      m_aqmDequeueDrops(0), m_useEcn(false), m_ecnMarks(0),
+      m_rateMode(RATE_UNLIMITED), m_committed(), m_peak(),
+      m_exceedAction(EXCEED_DROP), m_exceedDscp(0), m_policerDrops(0),
+      m_policerRemarks(0)
 {
   NS_LOG_FUNCTION(this);
+  m_queue.Reserve(m_maxPackets);
 }
 
 TrafficClass::~TrafficClass()
@@ -52,19 +206,22 @@ void TrafficClass::DoDispose(void)
 {
   NS_LOG_FUNCTION(this);
 
-  while (!m_queue.empty())
-  {
-    m_queue.pop();
-  }
+  m_queue.Clear();
+  m_flowQueues.SetNFlows(0);
+  m_bytes = 0;
 
   m_filters.clear();
+  m_aqm = 0;
+  m_dropCallback.Nullify();
+  m_dequeueCallback.Nullify();
+  m_changeCallback.Nullify();
 
   Object::DoDispose();
 }
 
-bool TrafficClass::Match(Ptr<Packet> p)
+bool TrafficClass::Match(const FlowKey& key) const
 {
-  NS_LOG_FUNCTION(this << p);
+  NS_LOG_FUNCTION(this << key);
 
   if (m_filters.empty())
   {
@@ -74,7 +231,7 @@ bool TrafficClass::Match(Ptr<Packet> p)
 
   for (uint32_t i = 0; i < m_filters.size(); i++)
   {
-    if (m_filters[i]->Match(p))
+    if (m_filters[i]->Match(key))
     {
       NS_LOG_LOGIC("Packet matches filter " << i);
       return true;
@@ -85,70 +242,531 @@ bool TrafficClass::Match(Ptr<Packet> p)
   return false;
 }
 
+bool TrafficClass::GetPatterns(std::vector<FlowPattern>& patterns) const
+{
+  NS_LOG_FUNCTION(this);
+
+  if (m_filters.empty())
+  {
+    patterns.push_back(FlowPattern::Any());
+    return true;
+  }
+
+  for (uint32_t i = 0; i < m_filters.size(); i++)
+  {
+    if (!m_filters[i]->GetPatterns(patterns))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TrafficClass::Fits(Ptr<const Packet> p) const
+{
+  uint32_t nPackets = m_flowMode ? m_flowQueues.GetSize() : m_queue.GetSize();
+  if (nPackets >= m_maxPackets)
+  {
+    NS_LOG_LOGIC("Queue full");
+    return false;
+  }
+  if (m_maxBytes > 0 && m_bytes + p->GetSize() > m_maxBytes)
+  {
+    NS_LOG_LOGIC("Byte limit reached");
+    return false;
+  }
+  return true;
+}
+
+void TrafficClass::DropStored(const QueuedPacket& entry)
+{
+  m_traceDrop(entry.packet);
+  if (!m_dropCallback.IsNull())
+  {
+    m_dropCallback(entry.packet, entry.position);
+  }
+}
+
 bool TrafficClass::Enqueue(Ptr<Packet> p)
 {
   NS_LOG_FUNCTION(this << p);
+  return Enqueue(p, (m_flowMode || m_useEcn) ? FlowKey::Parse(p) : FlowKey());
+}
 
-  if (m_packets >= m_maxPackets)
+bool TrafficClass::Enqueue(Ptr<Packet> p, const FlowKey& key)
+{
+  NS_LOG_FUNCTION(this << p << key);
+
+  bool mark = false;
+  if (!Admit(p, key, mark))
   {
-    NS_LOG_LOGIC("Queue full, dropping packet");
     return false;
   }
+  if (mark)
+  {
+    MarkCongestion(p);
+  }
+  Store(p, key, PacketPosition());
+  return true;
+}
 
-  m_queue.push(p);
-  m_packets++;
+bool TrafficClass::Admit(Ptr<Packet> p, const FlowKey& key, bool& mark)
+{
+  NS_LOG_FUNCTION(this << p << key);
 
-  NS_LOG_LOGIC("Packet enqueued, " << m_packets << " packets in queue");
+  mark = false;
+  if (m_rateMode == RATE_POLICE && !Police(p))
+  {
+    NS_LOG_LOGIC("Policer drops packet");
+    m_traceDrop(p);
+    return false;
+  }
+
+  if (!HasRoom(p))
+  {
+    NS_LOG_LOGIC("Dropping packet");
+    NotifyTailDrop(p);
+    return false;
+  }
+
+  if (m_aqm &&
+      m_aqm->CheckEnqueue(p, GetNPackets(), m_bytes) == ClassAqm::DROP)
+  {
+    if (!CanMarkCongestion(key))
+    {
+      NS_LOG_LOGIC("AQM drops packet at enqueue");
+      m_aqmEnqueueDrops++;
+      m_traceDrop(p);
+      return false;
+    }
+    // Marked by the owner only once the packet is stored
+    mark = true;
+  }
   return true;
 }
 
+void TrafficClass::Store(Ptr<Packet> p, const FlowKey& key,
+                         PacketPosition position)
+{
+  NS_LOG_FUNCTION(this << p << key);
+
+  // In flow mode the fattest flow pays for the overflow, not the arrival
+  while (m_flowMode && !m_flowQueues.IsEmpty() && !Fits(p))
+  {
+    QueuedPacket victim = m_flowQueues.PopFromFattest();
+    m_bytes -= victim.packet->GetSize();
+    m_overflowDrops++;
+    DropStored(victim);
+  }
+  NS_ASSERT_MSG(Fits(p), "Storing a packet that was not admitted");
+
+  QueuedPacket entry = {p, Simulator::Now(), position};
+  if (m_flowMode)
+  {
+    uint32_t flow = static_cast<uint32_t>(
+        (static_cast<uint64_t>(key.Hash()) * m_flowQueues.GetNFlows()) >> 32);
+    m_flowQueues.Push(flow, entry);
+  }
+  else
+  {
+    m_queue.Push(entry);
+  }
+  m_bytes += p->GetSize();
+
+  NS_LOG_LOGIC("Packet enqueued, " << GetNPackets() << " packets in queue");
+}
+
+bool TrafficClass::HasRoom(Ptr<const Packet> p) const
+{
+  if (Fits(p))
+  {
+    return true;
+  }
+  // In flow mode stored packets make room, if the arrival fits on its own
+  return m_flowMode && !m_flowQueues.IsEmpty() && m_maxPackets > 0 &&
+         (m_maxBytes == 0 || p->GetSize() <= m_maxBytes);
+}
+
+QueuedPacket TrafficClass::TakeStored(bool fromFront)
+{
+  NS_ASSERT(!IsEmpty());
+  QueuedPacket entry;
+  if (m_flowMode)
+  {
+    entry = m_flowQueues.PopFromFattest();
+  }
+  else
+  {
+    entry = fromFront ? m_queue.Pop() : m_queue.PopTail();
+  }
+  m_bytes -= entry.packet->GetSize();
+  return entry;
+}
+
+void TrafficClass::PushOut(bool fromFront)
+{
+  NS_LOG_FUNCTION(this << fromFront);
+
+  QueuedPacket entry = TakeStored(fromFront);
+  NS_LOG_LOGIC("Pushing out packet " << entry.packet << ", " << GetNPackets()
+                                     << " packets in queue");
+  m_pushOuts++;
+  DropStored(entry);
+}
+
+void TrafficClass::NotifyTailDrop(Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << p);
+  m_tailDrops++;
+  m_traceDrop(p);
+}
+
 Ptr<Packet> TrafficClass::Dequeue(void)
 {
   NS_LOG_FUNCTION(this);
 
-  if (m_queue.empty())
+  while (!IsEmpty())
+  {
+    QueuedPacket entry = m_flowMode ? m_flowQueues.Pop() : m_queue.Pop();
+    m_bytes -= entry.packet->GetSize();
+
+    if (m_aqm && m_aqm->CheckDequeue(entry.packet,
+                                     Simulator::Now() - entry.arrival,
+                                     GetNPackets(),
+                                     m_bytes) == ClassAqm::DROP &&
+        !MarkCongestion(entry.packet))
+    {
+      NS_LOG_LOGIC("AQM drops packet at dequeue");
+      m_aqmDequeueDrops++;
+      DropStored(entry);
+      continue;
+    }
+
+    if (m_rateMode == RATE_SHAPE && m_committed.IsEnabled())
+    {
+      Time now = Simulator::Now();
+      m_committed.Consume(now, entry.packet->GetSize());
+      if (m_peak.IsEnabled())
+      {
+        m_peak.Consume(now, entry.packet->GetSize());
+      }
+    }
+
+    NS_LOG_LOGIC("Packet dequeued, " << GetNPackets() << " packets in queue");
+    if (!m_dequeueCallback.IsNull())
+    {
+      m_dequeueCallback(entry.position);
+    }
+    return entry.packet;
+  }
+
+  NS_LOG_LOGIC("Queue empty");
+  return 0;
+}
+
+Ptr<Packet> TrafficClass::Peek(void) const
+{
+  NS_LOG_FUNCTION(this);
+
+  if (IsEmpty())
   {
     NS_LOG_LOGIC("Queue empty");
     return 0;
   }
 
-  Ptr<Packet> p = m_queue.front();
-  m_queue.pop();
-  m_packets--;
-
-  NS_LOG_LOGIC("Packet dequeued, " << m_packets << " packets in queue");
-  return p;
+  return m_flowMode ? m_flowQueues.Front().packet : m_queue.Front().packet;
 }
 
-Ptr<Packet> TrafficClass::Peek(void) const
+Ptr<Packet> TrafficClass::PeekTail(void) const
 {
   NS_LOG_FUNCTION(this);
 
-  if (m_queue.empty())
+  if (IsEmpty())
   {
     NS_LOG_LOGIC("Queue empty");
     return 0;
   }
 
-  return m_queue.front();
+  return m_flowMode ? m_flowQueues.Back().packet : m_queue.Back().packet;
 }
 
 bool TrafficClass::IsEmpty(void) const
 {
   NS_LOG_FUNCTION(this);
-  return m_queue.empty();
+  return m_flowMode ? m_flowQueues.IsEmpty() : m_queue.IsEmpty();
+}
+
+void TrafficClass::SetDropCallback(DropCallback cb)
+{
+  NS_LOG_FUNCTION(this);
+  m_dropCallback = cb;
+}
+
+void TrafficClass::SetDequeueCallback(DequeueCallback cb)
+{
+  NS_LOG_FUNCTION(this);
+  m_dequeueCallback = cb;
+}
+
+void TrafficClass::SetChangeCallback(ChangeCallback cb)
+{
+  NS_LOG_FUNCTION(this);
+  m_changeCallback = cb;
+}
+
+void TrafficClass::SetAqm(Ptr<ClassAqm> aqm)
+{
+  NS_LOG_FUNCTION(this << aqm);
+  m_aqm = aqm;
+}
+
+Ptr<ClassAqm> TrafficClass::GetAqm(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_aqm;
+}
+
+void TrafficClass::SetUseEcn(bool useEcn)
+{
+  NS_LOG_FUNCTION(this << useEcn);
+  m_useEcn = useEcn;
+}
+
+bool TrafficClass::GetUseEcn(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_useEcn;
+}
+
+bool TrafficClass::MarkCongestion(Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION(this << p);
+
+  if (m_useEcn && EcnMarker::MarkCe(p))
+  {
+    NS_LOG_LOGIC("Congestion signalled by ECN mark");
+    m_ecnMarks++;
+    return true;
+  }
+  return false;
+}
+
+bool TrafficClass::CanMarkCongestion(const FlowKey& key) const
+{
+  return m_useEcn && (key.flags & FlowKey::IPV4) &&
+         key.ecn != Ipv4Header::ECN_NotECT;
+}
+
+uint64_t TrafficClass::GetNEcnMarks(void) const
+{
+  return m_ecnMarks;
+}
+
+void TrafficClass::SetFlowQueues(uint32_t nFlows)
+{
+  NS_LOG_FUNCTION(this << nFlows);
+  NS_ASSERT_MSG(IsEmpty(), "Cannot change the flow queues of a busy class");
+  m_flowQueues.SetNFlows(nFlows);
+  m_flowMode = nFlows > 0;
+}
+
+uint32_t TrafficClass::GetFlowQueues(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_flowQueues.GetNFlows();
+}
+
+void TrafficClass::SetFlowQuantum(uint32_t quantum)
+{
+  NS_LOG_FUNCTION(this << quantum);
+  m_flowQueues.SetQuantum(quantum);
+}
+
+uint32_t TrafficClass::GetFlowQuantum(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_flowQueues.GetQuantum();
+}
+
+uint64_t TrafficClass::GetNOverflowDrops(void) const
+{
+  return m_overflowDrops;
+}
+
+uint64_t TrafficClass::GetNAqmEnqueueDrops(void) const
+{
+  return m_aqmEnqueueDrops;
+}
+
+uint64_t TrafficClass::GetNAqmDequeueDrops(void) const
+{
+  return m_aqmDequeueDrops;
+}
+
+bool TrafficClass::Police(Ptr<Packet> p)
+{
+  if (!m_committed.IsEnabled())
+  {
+    return true;
+  }
+
+  Time now = Simulator::Now();
+  uint32_t size = p->GetSize();
+  if (m_peak.IsEnabled() && !m_peak.Conforms(now, size))
+  {
+    NS_LOG_LOGIC("Arrival above the peak rate");
+    m_policerDrops++;
+    return false;
+  }
+
+  if (m_committed.Conforms(now, size))
+  {
+    m_committed.Consume(now, size);
+  }
+  else if (m_exceedAction == EXCEED_REMARK &&
+           EcnMarker::SetDscp(p, m_exceedDscp))
+  {
+    NS_LOG_LOGIC("Arrival above the committed rate, re-marked");
+    m_policerRemarks++;
+  }
+  else
+  {
+    NS_LOG_LOGIC("Arrival above the committed rate");
+    m_policerDrops++;
+    return false;
+  }
+
+  if (m_peak.IsEnabled())
+  {
+    m_peak.Consume(now, size);
+  }
+  return true;
+}
+
+Time TrafficClass::GetHoldTime(void)
+{
+  if (m_rateMode != RATE_SHAPE || !m_committed.IsEnabled() || IsEmpty())
+  {
+    return Time(0);
+  }
+
+  Time now = Simulator::Now();
+  uint32_t size = Peek()->GetSize();
+  Time hold = m_committed.GetDelay(now, size);
+  if (m_peak.IsEnabled())
+  {
+    Time peakHold = m_peak.GetDelay(now, size);
+    hold = (peakHold > hold) ? peakHold : hold;
+  }
+  return hold;
+}
+
+void TrafficClass::SetRateMode(RateMode mode)
+{
+  NS_LOG_FUNCTION(this << mode);
+  m_rateMode = mode;
+}
+
+TrafficClass::RateMode TrafficClass::GetRateMode(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_rateMode;
+}
+
+void TrafficClass::SetCir(DataRate cir)
+{
+  NS_LOG_FUNCTION(this << cir);
+  m_committed.SetRate(cir, m_committed.GetBurst());
+}
+
+DataRate TrafficClass::GetCir(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_committed.GetRate();
+}
+
+void TrafficClass::SetCbs(uint32_t cbs)
+{
+  NS_LOG_FUNCTION(this << cbs);
+  m_committed.SetRate(m_committed.GetRate(), cbs);
+}
+
+uint32_t TrafficClass::GetCbs(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_committed.GetBurst();
+}
+
+void TrafficClass::SetPir(DataRate pir)
+{
+  NS_LOG_FUNCTION(this << pir);
+  m_peak.SetRate(pir, m_peak.GetBurst());
+}
+
+DataRate TrafficClass::GetPir(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_peak.GetRate();
+}
+
+void TrafficClass::SetPbs(uint32_t pbs)
+{
+  NS_LOG_FUNCTION(this << pbs);
+  m_peak.SetRate(m_peak.GetRate(), pbs);
+}
+
+uint32_t TrafficClass::GetPbs(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_peak.GetBurst();
+}
+
+uint64_t TrafficClass::GetNPolicerDrops(void) const
+{
+  return m_policerDrops;
+}
+
+uint64_t TrafficClass::GetNPolicerRemarks(void) const
+{
+  return m_policerRemarks;
+}
+
+uint64_t TrafficClass::GetNPushOuts(void) const
+{
+  return m_pushOuts;
+}
+
+uint64_t TrafficClass::GetNTailDrops(void) const
+{
+  return m_tailDrops;
 }
 
 void TrafficClass::AddFilter(Ptr<Filter> filter)
 {
   NS_LOG_FUNCTION(this << filter);
   m_filters.push_back(filter);
+  m_rulesVersion++;
+  CompiledClassifier::NotifyRulesChanged();
+}
+
+uint64_t TrafficClass::GetRulesVersion(void) const
+{
+  uint64_t version = m_rulesVersion;
+  for (uint32_t i = 0; i < m_filters.size(); i++)
+  {
+    version += m_filters[i]->GetRulesVersion();
+  }
+  return version;
 }
 
 void TrafficClass::SetPriorityLevel(uint32_t level)
 {
   NS_LOG_FUNCTION(this << level);
   m_priorityLevel = level;
+  if (!m_changeCallback.IsNull())
+  {
+    m_changeCallback();
+  }
 }
 
 uint32_t TrafficClass::GetPriorityLevel(void) const
@@ -161,6 +779,10 @@ void TrafficClass::SetWeight(double weight)
 {
   NS_LOG_FUNCTION(this << weight);
   m_weight = weight;
+  if (!m_changeCallback.IsNull())
+  {
+    m_changeCallback();
+  }
 }
 
 double TrafficClass::GetWeight(void) const
@@ -169,10 +791,25 @@ double TrafficClass::GetWeight(void) const
   return m_weight;
 }
 
+void TrafficClass::SetAlpha(double alpha)
+{
+  NS_LOG_FUNCTION(this << alpha);
+  m_alpha = alpha;
+}
+
+double TrafficClass::GetAlpha(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_alpha;
+}
+
 void TrafficClass::SetMaxPackets(uint32_t maxPackets)
 {
   NS_LOG_FUNCTION(this << maxPackets);
   m_maxPackets = maxPackets;
+  m_queue.Reserve(maxPackets < MAX_PREALLOCATED_PACKETS
+                      ? maxPackets
+                      : MAX_PREALLOCATED_PACKETS);
 }
 
 uint32_t TrafficClass::GetMaxPackets(void) const
@@ -181,10 +818,28 @@ uint32_t TrafficClass::GetMaxPackets(void) const
   return m_maxPackets;
 }
 
+void TrafficClass::SetMaxBytes(uint32_t maxBytes)
+{
+  NS_LOG_FUNCTION(this << maxBytes);
+  m_maxBytes = maxBytes;
+}
+
+uint32_t TrafficClass::GetMaxBytes(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_maxBytes;
+}
+
 uint32_t TrafficClass::GetNPackets(void) const
 {
   NS_LOG_FUNCTION(this);
-  return m_packets;
+  return m_flowMode ? m_flowQueues.GetSize() : m_queue.GetSize();
+}
+
+uint32_t TrafficClass::GetNBytes(void) const
+{
+  NS_LOG_FUNCTION(this);
+  return m_bytes;
 }
 
 }
\ No newline at end of file
@@ -1,10 +1,18 @@
 #ifndef TRAFFIC_CLASS_H
 #define TRAFFIC_CLASS_H
 
+#include "class-aqm.h"
+#include "flow-key.h"
+#include "flow-queue-set.h"
+#include "ns3/callback.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/queue.h"
-#include <queue>
+#include "ns3/traced-callback.h"
+#include "ring-buffer.h"
+#include "token-bucket.h"
 #include <vector>
 
 namespace ns3
@@ -14,10 +22,44 @@ class Filter;
 
 /**
  * \brief Traffic class for differentiated services
+ *
+ * Packets are stamped with their arrival time; an optional ClassAqm sees
+ * every arrival and every departure with its sojourn time and may drop it.
+ * With UseEcn, such congestion signals mark ECN-capable packets CE instead.
+ *
+ * With FlowQueues set, the class hashes the 5-tuple of each packet into
+ * that many sub-queues served by byte-based DRR (see FlowQueueSet), and a
+ * full class makes room by dropping from the sub-queue holding the most
+ * bytes instead of refusing the arrival.
+ *
+ * A committed token bucket (Cir, Cbs) and an optional peak bucket (Pir,
+ * Pbs), refilled lazily, control the rate of the class.  As a policer
+ * they meter arrivals: packets above the peak rate are dropped, packets
+ * above the committed rate are dropped or re-marked with ExceedDscp.  As a
+ * shaper they meter departures: the head packet is held (see GetHoldTime)
+ * until both buckets hold enough tokens for it.
+ *
+ * Every packet the class loses, refused on arrival or dropped after it
+ * was stored, is reported through the Drop trace source.
  */
 class TrafficClass : public Object
 {
 public:
+  /// What the token buckets of the class do
+  enum RateMode
+  {
+    RATE_UNLIMITED, //!< no rate control
+    RATE_POLICE,    //!< drop or re-mark out-of-profile arrivals
+    RATE_SHAPE,     //!< hold packets until they are in profile
+  };
+
+  /// What the policer does with arrivals above the committed rate
+  enum ExceedAction
+  {
+    EXCEED_DROP,   //!< drop them
+    EXCEED_REMARK, //!< re-mark them with ExceedDscp and admit them
+  };
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -36,10 +78,17 @@ public:
 
   /**
    * \brief Check if a packet matches this traffic class
-   * \param p The packet to check
-   * \return True if the packet matches this traffic class
+   * \param key The classification key parsed from the packet
+   * \return True if the packet matches any filter of this traffic class
+   */
+  bool Match(const FlowKey& key) const;
+
+  /**
+   * \brief Describe the filters of this class as masked key patterns
+   * \param patterns Output: the patterns, appended to the vector
+   * \return False if a filter cannot be expressed as patterns
    */
-  bool Match(Ptr<Packet> p);
+  bool GetPatterns(std::vector<FlowPattern>& patterns) const;
 
   /**
    * \brief Enqueue a packet
@@ -48,9 +97,82 @@ public:
    */
   bool Enqueue(Ptr<Packet> p);
 
+  /**
+   * \brief Enqueue an already parsed packet
+   *
+   * Admit followed, if the packet is admitted, by Store.
+   *
+   * \param p The packet to enqueue
+   * \param key The classification key parsed from the packet
+   * \return True if the packet was enqueued
+   */
+  bool Enqueue(Ptr<Packet> p, const FlowKey& key);
+
+  /**
+   * \brief Check an arrival against the policer, the limits and the AQM
+   *
+   * The first half of Enqueue; no stored packet is dropped, so the owner
+   * can still refuse an admitted packet for lack of shared buffer, or make
+   * room for it, before calling Store.  A refused packet is counted and
+   * reported through the Drop trace.  An ECN-capable packet the AQM would
+   * drop is admitted instead; the owner marks it CE with MarkCongestion
+   * once it is known to be stored.
+   *
+   * \param p The arriving packet, re-marked by the policer if needed
+   * \param key The classification key parsed from the packet
+   * \param mark Set to true if the packet must be marked CE when stored
+   * \return True if the packet may be stored
+   */
+  bool Admit(Ptr<Packet> p, const FlowKey& key, bool& mark);
+
+  /**
+   * \brief Store a packet admitted by Admit
+   *
+   * In flow mode the sub-queue holding the most bytes makes room first if
+   * the class is full.
+   *
+   * \param p The packet
+   * \param key The classification key parsed from the packet
+   * \param position The base queue entry of the packet, handed back to the
+   *        drop and dequeue callbacks
+   */
+  void Store(Ptr<Packet> p, const FlowKey& key, PacketPosition position);
+
+  /**
+   * \brief Check whether an arrival fits within the limits of the class
+   *
+   * In flow mode a backlogged class makes room by itself for any packet
+   * that fits in it alone.
+   *
+   * \param p The arriving packet
+   * \return True if Enqueue would not refuse the packet for lack of room
+   */
+  bool HasRoom(Ptr<const Packet> p) const;
+
+  /**
+   * \brief Drop a stored packet to make room for an arrival elsewhere
+   *
+   * The packet is handed to the drop callback.  In flow mode the head
+   * packet of the sub-queue holding the most bytes is dropped, whichever
+   * end is asked for.
+   *
+   * \param fromFront True to drop the head packet, false the tail packet
+   */
+  void PushOut(bool fromFront);
+
+  /**
+   * \brief Report an arrival for this class refused by the DiffServ queue
+   * \param p The packet
+   */
+  void NotifyTailDrop(Ptr<const Packet> p);
+
   /**
    * \brief Dequeue a packet
-   * \return The dequeued packet
+   *
+   * Packets dropped by the AQM on their way out are handed to the drop
+   * callback and skipped.
+   *
+   * \return The dequeued packet, or 0 if the class is (or became) empty
    */
   Ptr<Packet> Dequeue(void);
 
@@ -60,18 +182,208 @@ public:
    */
   Ptr<Packet> Peek(void) const;
 
+  /**
+   * \brief Peek at the most recently enqueued packet
+   * \return The packet at the back of the queue
+   */
+  Ptr<Packet> PeekTail(void) const;
+
   /**
    * \brief Check if the queue is empty
    * \return True if the queue is empty
    */
   bool IsEmpty(void) const;
 
+  /// Callback invoked with each stored packet dropped, and its position
+  typedef Callback<void, Ptr<Packet>, PacketPosition> DropCallback;
+
+  /**
+   * \brief Set the callback told about stored packets being dropped
+   * \param cb The callback
+   */
+  void SetDropCallback(DropCallback cb);
+
+  /// Callback invoked with the position of each packet Dequeue returns
+  typedef Callback<void, PacketPosition> DequeueCallback;
+
+  /**
+   * \brief Set the callback told about packets leaving through Dequeue
+   * \param cb The callback
+   */
+  void SetDequeueCallback(DequeueCallback cb);
+
+  /// Callback invoked when a scheduling parameter of the class changes
+  typedef Callback<void> ChangeCallback;
+
+  /**
+   * \brief Set the callback told about priority level and weight changes
+   *
+   * Neither is a classification input: changing them only tells the
+   * owning queue to update its scheduler.
+   *
+   * \param cb The callback
+   */
+  void SetChangeCallback(ChangeCallback cb);
+
+  /**
+   * \brief Set the active queue management of this class
+   * \param aqm The AQM, or 0 for tail drop only
+   */
+  void SetAqm(Ptr<ClassAqm> aqm);
+
+  /**
+   * \brief Get the active queue management of this class
+   * \return The AQM, or 0 for tail drop only
+   */
+  Ptr<ClassAqm> GetAqm(void) const;
+
+  /**
+   * \brief Enable ECN marking instead of dropping for congestion signals
+   * \param useEcn True to mark ECN-capable packets
+   */
+  void SetUseEcn(bool useEcn);
+
+  /**
+   * \brief Check if congestion signals may mark instead of drop
+   * \return True if ECN marking is enabled
+   */
+  bool GetUseEcn(void) const;
+
+  /**
+   * \brief Signal congestion on a packet by marking it, if possible
+   *
+   * Used for the decisions of the AQM of this class and for the admission
+   * threshold of the DiffServ queue.
+   *
+   * \param p The packet
+   * \return True if the packet was marked CE and may be kept; false if it
+   *         has to be dropped (ECN disabled or packet not ECN-capable)
+   */
+  bool MarkCongestion(Ptr<Packet> p);
+
+  /**
+   * \brief Check whether MarkCongestion would keep a packet
+   * \param key The classification key parsed from the packet
+   * \return True if ECN is enabled and the packet is ECN-capable
+   */
+  bool CanMarkCongestion(const FlowKey& key) const;
+
+  /**
+   * \return The number of packets marked CE instead of being dropped
+   */
+  uint64_t GetNEcnMarks(void) const;
+
+  /**
+   * \return The number of stored packets dropped to make room for arrivals
+   *         in flow mode
+   */
+  uint64_t GetNOverflowDrops(void) const;
+
+  /**
+   * \return The number of stored packets pushed out for other arrivals
+   */
+  uint64_t GetNPushOuts(void) const;
+
+  /**
+   * \return The number of arrivals refused for lack of room, in the class
+   *         or in the shared buffer
+   */
+  uint64_t GetNTailDrops(void) const;
+
+  /**
+   * \return The number of arrivals dropped by the AQM
+   */
+  uint64_t GetNAqmEnqueueDrops(void) const;
+
+  /**
+   * \return The number of stored packets dropped by the AQM at dequeue
+   */
+  uint64_t GetNAqmDequeueDrops(void) const;
+
+  /**
+   * \brief Set what the token buckets of the class do
+   * \param mode The rate mode
+   */
+  void SetRateMode(RateMode mode);
+
+  /**
+   * \return What the token buckets of the class do
+   */
+  RateMode GetRateMode(void) const;
+
+  /**
+   * \brief Set the committed information rate
+   * \param cir The rate; 0 disables rate control
+   */
+  void SetCir(DataRate cir);
+
+  /**
+   * \return The committed information rate
+   */
+  DataRate GetCir(void) const;
+
+  /**
+   * \brief Set the committed burst size
+   * \param cbs The size in bytes, at least one MTU
+   */
+  void SetCbs(uint32_t cbs);
+
+  /**
+   * \return The committed burst size in bytes
+   */
+  uint32_t GetCbs(void) const;
+
+  /**
+   * \brief Set the peak information rate
+   * \param pir The rate; 0 for a single-rate meter
+   */
+  void SetPir(DataRate pir);
+
+  /**
+   * \return The peak information rate
+   */
+  DataRate GetPir(void) const;
+
+  /**
+   * \brief Set the peak burst size
+   * \param pbs The size in bytes, at least one MTU
+   */
+  void SetPbs(uint32_t pbs);
+
+  /**
+   * \return The peak burst size in bytes
+   */
+  uint32_t GetPbs(void) const;
+
+  /**
+   * \brief Get how long the shaper holds the head packet
+   * \return The time until the head packet is in profile; zero if it may
+   *         leave now, the class is empty or it is not shaped
+   */
+  Time GetHoldTime(void);
+
+  /**
+   * \return The number of arrivals dropped by the policer
+   */
+  uint64_t GetNPolicerDrops(void) const;
+
+  /**
+   * \return The number of arrivals re-marked by the policer
+   */
+  uint64_t GetNPolicerRemarks(void) const;
+
   /**
    * \brief Add a filter to this traffic class
    * \param filter The filter to add
    */
   void AddFilter(Ptr<Filter> filter);
 
+  /**
+   * \brief Get the version of the packets this class matches
+   * \return A counter moving whenever a filter is added or changed
+   */
+  uint64_t GetRulesVersion(void) const;
+
   /**
    * \brief Set the priority level
    * \param level The priority level
@@ -96,8 +408,28 @@ public:
    */
   double GetWeight(void) const;
 
+  /**
+   * \brief Set the dynamic threshold factor
+   *
+   * With dynamic thresholds enabled on the DiffServ queue, this class may
+   * hold at most alpha times the currently free shared buffer.
+   *
+   * \param alpha The factor
+   */
+  void SetAlpha(double alpha);
+
+  /**
+   * \brief Get the dynamic threshold factor
+   * \return The factor
+   */
+  double GetAlpha(void) const;
+
   /**
    * \brief Set the maximum number of packets
+   *
+   * The packet storage is preallocated for this many packets (up to
+   * MAX_PREALLOCATED_PACKETS; beyond that it grows on demand).
+   *
    * \param maxPackets The maximum number of packets
    */
   void SetMaxPackets(uint32_t maxPackets);
@@ -108,12 +440,57 @@ public:
    */
   uint32_t GetMaxPackets(void) const;
 
+  /**
+   * \brief Set the maximum number of bytes
+   * \param maxBytes The maximum number of bytes; 0 means no byte limit
+   */
+  void SetMaxBytes(uint32_t maxBytes);
+
+  /**
+   * \brief Get the maximum number of bytes
+   * \return The maximum number of bytes; 0 means no byte limit
+   */
+  uint32_t GetMaxBytes(void) const;
+
+  /**
+   * \brief Set the number of per-flow sub-queues
+   *
+   * Must be called while the class is empty.
+   *
+   * \param nFlows The number of sub-queues; 0 for a single FIFO
+   */
+  void SetFlowQueues(uint32_t nFlows);
+
+  /**
+   * \brief Get the number of per-flow sub-queues
+   * \return The number of sub-queues; 0 for a single FIFO
+   */
+  uint32_t GetFlowQueues(void) const;
+
+  /**
+   * \brief Set the DRR quantum of the per-flow sub-queues
+   * \param quantum The quantum in bytes
+   */
+  void SetFlowQuantum(uint32_t quantum);
+
+  /**
+   * \brief Get the DRR quantum of the per-flow sub-queues
+   * \return The quantum in bytes
+   */
+  uint32_t GetFlowQuantum(void) const;
+
   /**
    * \brief Get the number of packets
    * \return The number of packets
    */
   uint32_t GetNPackets(void) const;
 
+  /**
+   * \brief Get the number of bytes
+   * \return The total size of the stored packets
+   */
+  uint32_t GetNBytes(void) const;
+
 protected:
   /**
    * \brief Dispose of the object
@@ -121,13 +498,69 @@ protected:
   virtual void DoDispose(void);
 
 private:
+  /// Largest packet storage allocated up front by SetMaxPackets
+  static const uint32_t MAX_PREALLOCATED_PACKETS = 65536;
+
+  /**
+   * \brief Check the packet and byte limits for an arrival
+   * \param p The arriving packet
+   * \return True if the packet fits
+   */
+  bool Fits(Ptr<const Packet> p) const;
+
+  /**
+   * \brief Meter an arrival against the policer
+   * \param p The arriving packet, re-marked if it exceeds the committed
+   *        rate and the exceed action is EXCEED_REMARK
+   * \return False if the packet must be dropped
+   */
+  bool Police(Ptr<Packet> p);
+
+  /**
+   * \brief Hand a stored packet dropped by this class to the drop callback
+   * \param entry The packet and its position
+   */
+  void DropStored(const QueuedPacket& entry);
+
+  /**
+   * \brief Remove a stored packet and account it
+   * \param fromFront True for the head packet, false for the tail packet
+   * \return The packet and its position; the class must not be empty
+   */
+  QueuedPacket TakeStored(bool fromFront);
+
   std::vector<Ptr<Filter>> m_filters;
+  uint64_t m_rulesVersion;         //!< filters added
   uint32_t m_mode;
-  uint32_t m_packets;
   uint32_t m_maxPackets;
+  uint32_t m_maxBytes;             //!< byte limit, 0 for none
+  uint32_t m_bytes;                //!< total size of the stored packets
   double m_weight;
+  double m_alpha;                  //!< dynamic threshold factor
   uint32_t m_priorityLevel;
-  std::queue<Ptr<Packet>> m_queue;
+  RingBuffer<QueuedPacket> m_queue; //!< stored packets, head is next out
+  FlowQueueSet m_flowQueues;       //!< per-flow storage, used instead of
+                                   //!< m_queue when it has sub-queues
+  bool m_flowMode;                 //!< m_flowQueues holds the packets
+  uint64_t m_overflowDrops;        //!< stored packets pushed out when full
+  uint64_t m_pushOuts;             //!< stored packets dropped for others
+  uint64_t m_tailDrops;            //!< arrivals refused for lack of room
+  TracedCallback<Ptr<const Packet>> m_traceDrop; //!< packets lost
+  Ptr<ClassAqm> m_aqm;             //!< active queue management, if any
+  DropCallback m_dropCallback;     //!< told about stored packets dropped
+  DequeueCallback m_dequeueCallback; //!< told about packets dequeued
+  ChangeCallback m_changeCallback; //!< told about scheduling changes
+  uint64_t m_aqmEnqueueDrops;      //!< arrivals dropped by the AQM
+  uint64_t m_aqmDequeueDrops;      //!< departures dropped by the AQM
+  bool m_useEcn;                   //!< mark instead of drop when possible
+  uint64_t m_ecnMarks;             //!< packets marked CE
+  RateMode m_rateMode;             //!< what the token buckets do
+  TokenBucket m_committed;         //!< CIR and CBS
+  TokenBucket m_peak;              //!< PIR and PBS, disabled if single-rate
+  ExceedAction m_exceedAction;     //!< fate of arrivals above the CIR
+  uint8_t m_exceedDscp;            //!< codepoint for re-marked arrivals
+  uint64_t m_policerDrops;         //!< arrivals dropped by the policer
+  uint64_t m_policerRemarks;       //!< arrivals re-marked by the policer
 };
 
 }
@@ -0,0 +1,274 @@
+#include "wfq.h"
+#include "class-aqm.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "traffic-class.h"
+#include <fstream>
+#include <sstream>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("WFQ");
+NS_OBJECT_ENSURE_REGISTERED(WFQ);
+
+TypeId WFQ::GetTypeId(void)
+{
+  static TypeId tid = TypeId("ns3::WFQ")
+                          .SetParent<DiffServ>()
+                          .SetGroupName("Network")
+                          .AddConstructor<WFQ>();
+  return tid;
+}
+
+WFQ::WFQ()
+    : DiffServ(), m_state(), m_pending(), m_eligible(), m_held(),
+      m_virtualTime(0), m_totalWeight(0), m_weightGeneration(0),
+      m_configFile("")
+{
+  NS_LOG_FUNCTION(this);
+}
+
+WFQ::~WFQ()
+{
+  NS_LOG_FUNCTION(this);
+}
+
+void WFQ::DoDispose(void)
+{
+  NS_LOG_FUNCTION(this);
+  m_state.clear();
+  m_pending = Heap();
+  m_eligible = Heap();
+  m_held.clear();
+  DiffServ::DoDispose();
+}
+
+bool WFQ::SetConfigFile(std::string filename)
+{
+  NS_LOG_FUNCTION(this << filename);
+  m_configFile = filename;
+  std::ifstream configFileStream(filename.c_str());
+  if (!configFileStream.is_open())
+  {
+    NS_LOG_ERROR("WFQ: Can't open WFQ config file: " << filename);
+    return false;
+  }
+
+  uint32_t numQueuesFromFile;
+  configFileStream >> numQueuesFromFile;
+  if (configFileStream.fail() || numQueuesFromFile == 0)
+  {
+    NS_LOG_ERROR("WFQ: Invalid number of queues in WFQ config file: "
+                 << filename << ". Read: " << numQueuesFromFile);
+    return false;
+  }
+
+  for (uint32_t i = GetNTrafficClasses(); i < numQueuesFromFile; ++i)
+  {
+    AddTrafficClass(CreateObject<TrafficClass>());
+  }
+
+  // One queue per line: weight, optionally followed by an AQM name
+  std::string line;
+  for (uint32_t i = 0; i < numQueuesFromFile; ++i)
+  {
+    while (std::getline(configFileStream, line) &&
+           line.find_first_not_of(" \t\r") == std::string::npos)
+    {
+    }
+    std::istringstream lineStream(line);
+    double weight = 0;
+    lineStream >> weight;
+    if (configFileStream.fail() || lineStream.fail() || weight <= 0)
+    {
+      NS_LOG_ERROR("WFQ: Invalid weight for queue "
+                   << i << " in WFQ config file: " << filename);
+      return false;
+    }
+    std::string aqmName;
+    if (lineStream >> aqmName)
+    {
+      Ptr<ClassAqm> aqm;
+      if (!ClassAqm::CreateFromName(aqmName, aqm))
+      {
+        NS_LOG_ERROR("WFQ: Invalid AQM " << aqmName << " for queue " << i
+                                         << " in WFQ config file: "
+                                         << filename);
+        return false;
+      }
+      GetTrafficClass(i)->SetAqm(aqm);
+    }
+    GetTrafficClass(i)->SetWeight(weight);
+    NS_LOG_INFO("WFQ: Queue " << i << " - Weight: " << weight);
+  }
+
+  // Weights changed, so the total must be recomputed
+  m_state.clear();
+  m_pending = Heap();
+  m_eligible = Heap();
+  RefreshClasses();
+  for (uint32_t i = 0; i < m_classes.size(); i++)
+  {
+    if (!m_classes[i]->IsEmpty())
+    {
+      m_state[i].backlogged = true;
+      StampHead(i, m_virtualTime);
+    }
+  }
+
+  NS_LOG_INFO("WFQ: Configuration loaded successfully from " << filename);
+  return true;
+}
+
+double WFQ::GetVirtualTime(void) const
+{
+  return m_virtualTime;
+}
+
+void WFQ::RefreshClasses(void)
+{
+  if (m_state.size() == m_classes.size() &&
+      m_weightGeneration == GetSchedulingGeneration())
+  {
+    return;
+  }
+
+  ClassState idle = {0, 0, false};
+  m_state.resize(m_classes.size(), idle);
+  m_totalWeight = 0;
+  for (uint32_t i = 0; i < m_classes.size(); i++)
+  {
+    m_totalWeight += m_classes[i]->GetWeight();
+  }
+  m_weightGeneration = GetSchedulingGeneration();
+}
+
+void WFQ::StampHead(uint32_t classIndex, double start)
+{
+  double weight = m_classes[classIndex]->GetWeight();
+  NS_ASSERT_MSG(weight > 0, "WFQ needs a positive weight for every class");
+
+  ClassState& state = m_state[classIndex];
+  state.start = start;
+  state.finish = start + m_classes[classIndex]->Peek()->GetSize() / weight;
+  m_pending.push(HeapEntry(state.start, classIndex));
+}
+
+void WFQ::NotifyEnqueue(uint32_t classIndex, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION(this << classIndex << p);
+
+  RefreshClasses();
+  ClassState& state = m_state[classIndex];
+  if (!state.backlogged)
+  {
+    state.backlogged = true;
+    StampHead(classIndex, (state.finish > m_virtualTime) ? state.finish
+                                                         : m_virtualTime);
+    NS_LOG_LOGIC("WFQ: Queue " << classIndex << " backlogged, start "
+                               << state.start << " finish " << state.finish);
+  }
+}
+
+Ptr<Packet> WFQ::Schedule(void)
+{
+  NS_LOG_FUNCTION(this);
+
+  RefreshClasses();
+  while (!m_pending.empty() || !m_eligible.empty())
+  {
+    if (m_eligible.empty())
+    {
+      if (m_held.empty())
+      {
+        // Nothing is eligible: move on to the next start time
+        if (m_pending.top().first > m_virtualTime)
+        {
+          m_virtualTime = m_pending.top().first;
+        }
+      }
+      else
+      {
+        // Only held classes were eligible: try the next class by start
+        // time without moving virtual time, which the held classes would
+        // otherwise fall behind
+        m_eligible.push(
+            HeapEntry(m_state[m_pending.top().second].finish,
+                      m_pending.top().second));
+        m_pending.pop();
+      }
+    }
+    while (!m_pending.empty() && m_pending.top().first <= m_virtualTime)
+    {
+      uint32_t classIndex = m_pending.top().second;
+      m_pending.pop();
+      m_eligible.push(HeapEntry(m_state[classIndex].finish, classIndex));
+    }
+
+    // Classes held by their shaper step aside until the next decision
+    while (!m_eligible.empty() &&
+           !m_classes[m_eligible.top().second]->IsEmpty() &&
+           !CanServe(m_eligible.top().second))
+    {
+      m_held.push_back(m_eligible.top());
+      m_eligible.pop();
+    }
+    if (m_eligible.empty())
+    {
+      continue;
+    }
+
+    uint32_t classIndex = m_eligible.top().second;
+    m_eligible.pop();
+    ClassState& state = m_state[classIndex];
+
+    Ptr<Packet> p = m_classes[classIndex]->Dequeue();
+    if (!p)
+    {
+      // Drained behind our back (e.g. by the AQM)
+      state.backlogged = false;
+      continue;
+    }
+
+    m_virtualTime += p->GetSize() / m_totalWeight;
+    if (m_classes[classIndex]->IsEmpty())
+    {
+      state.backlogged = false;
+    }
+    else
+    {
+      StampHead(classIndex, state.finish);
+    }
+    NS_LOG_LOGIC("WFQ: Dequeued " << p->GetSize() << "B from queue "
+                                  << classIndex << ", virtual time "
+                                  << m_virtualTime);
+    RestoreHeld();
+    return p;
+  }
+
+  RestoreHeld();
+  NS_LOG_LOGIC("WFQ: No queue may be served");
+  return 0;
+}
+
+void WFQ::RestoreHeld(void)
+{
+  for (uint32_t i = 0; i < m_held.size(); i++)
+  {
+    uint32_t classIndex = m_held[i].second;
+    if (m_state[classIndex].finish < m_virtualTime)
+    {
+      // No credit for the service missed while held: restart the head
+      // packet from the current virtual time
+      StampHead(classIndex, m_virtualTime);
+    }
+    else
+    {
+      m_eligible.push(m_held[i]);
+    }
+  }
+  m_held.clear();
+}
+
+}
@@ -0,0 +1,128 @@
+#ifndef WFQ_H
+#define WFQ_H
+
+#include "diffserv.h"
+#include <functional>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup queue
+ * \brief Worst-case fair weighted fair queueing (WF2Q+)
+ *
+ * Each backlogged class carries the virtual start and finish times of its
+ * head packet, the finish time being the start plus the packet size over
+ * the class Weight.  The system virtual time advances by the bytes sent
+ * over the total weight of the classes, and jumps to the smallest start
+ * time when no class is eligible.  Among the classes whose start time has
+ * been reached, the one with the smallest finish time is served.
+ *
+ * Classes wait in a min-heap on start time until they become eligible and
+ * then move to a min-heap on finish time, so a dequeue costs O(log N).
+ * Unlike DRR, a class is never more than one maximum packet ahead of its
+ * fluid share, which keeps the delay of small-packet classes low.  A class
+ * whose shaper holds its head packet keeps its stamps and is passed over.
+ */
+class WFQ : public DiffServ
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId(void);
+
+  /**
+   * \brief Constructor
+   */
+  WFQ();
+
+  /**
+   * \brief Destructor
+   */
+  virtual ~WFQ();
+
+  virtual Ptr<Packet> Schedule(void) override;
+
+  /**
+   * \brief Set the class weights from a configuration file
+   *
+   * The file holds the number of queues, then one line per queue with its
+   * weight, optionally followed by an AQM name, as drr.config does with
+   * quanta.
+   *
+   * \param filename The path to the configuration file.
+   * \return True if configuration was successful, false otherwise.
+   */
+  bool SetConfigFile(std::string filename);
+
+  /**
+   * \return The system virtual time, in bytes per unit of weight
+   */
+  double GetVirtualTime(void) const;
+
+protected:
+  virtual void DoDispose(void) override;
+
+  /**
+   * \brief Stamp a class that became backlogged and queue it
+   * \param classIndex The index of the traffic class
+   * \param p The enqueued packet
+   */
+  virtual void NotifyEnqueue(uint32_t classIndex,
+                             Ptr<const Packet> p) override;
+
+private:
+  /// Virtual time stamps of a class
+  struct ClassState
+  {
+    double start;    //!< virtual start time of the head packet
+    double finish;   //!< virtual finish time of the head packet
+    bool backlogged; //!< the class is in one of the heaps
+  };
+
+  /// (virtual time, class index), smallest first
+  typedef std::pair<double, uint32_t> HeapEntry;
+  /// Min-heap of classes
+  typedef std::priority_queue<HeapEntry, std::vector<HeapEntry>,
+                              std::greater<HeapEntry>>
+      Heap;
+
+  /**
+   * \brief Track classes added and weights changed since the last call
+   */
+  void RefreshClasses(void);
+
+  /**
+   * \brief Stamp the head packet of a class and queue it by start time
+   * \param classIndex The index of the traffic class
+   * \param start The virtual start time of the head packet
+   */
+  void StampHead(uint32_t classIndex, double start);
+
+  /**
+   * \brief Return the classes set aside as held to the eligible heap
+   *
+   * A class whose head packet should have finished by now is stamped
+   * again from the current virtual time.
+   */
+  void RestoreHeld(void);
+
+  std::vector<ClassState> m_state; //!< stamps of each class
+  Heap m_pending;                  //!< backlogged classes by start time
+  Heap m_eligible;                 //!< eligible classes by finish time
+  std::vector<HeapEntry> m_held;   //!< eligible classes held by a shaper
+  double m_virtualTime;            //!< system virtual time
+  double m_totalWeight;            //!< sum of the class weights
+  uint64_t m_weightGeneration;     //!< scheduling generation of the sum
+  std::string m_configFile;        //!< last configuration file
+};
+
+}
+
+#endif